@@ -0,0 +1,285 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "exec_time.hpp"
+#include "mapped_file.hpp"
+#include "rng.hpp"
+
+// Layout of a matrix file: this header, followed by the rows * cols
+// elements, row by row, in the byte order of the machine.
+struct matrix_header_t {
+  char magic[8];
+  uint64_t rows;
+  uint64_t cols;
+  uint64_t elem_size;
+};
+static_assert(sizeof(matrix_header_t) == 32, "matrix header must be packed");
+
+static const char MATRIX_MAGIC[8] = {'M', '6', '0', '0', '6', 'M', '2', 'D'};
+
+// Read-only rows x cols matrix over row-major elements it does not own.
+template <typename T> class matrix_view {
+private:
+  const T *mData;
+  size_t mRows;
+  size_t mCols;
+
+public:
+  matrix_view() : mData(nullptr), mRows(0), mCols(0) {}
+
+  matrix_view(const T *data, size_t rows, size_t cols)
+      : mData(data), mRows(rows), mCols(cols) {}
+
+  size_t rows() const { return mRows; }
+
+  size_t cols() const { return mCols; }
+
+  const T &operator()(size_t r, size_t c) const { return mData[r * mCols + c]; }
+};
+
+// Write a rows x cols matrix of gen(r, c) values to a matrix file, one row
+// at a time. false if the file cannot be written.
+template <typename T, typename GEN>
+bool write_matrix_file(const std::string &fname, size_t rows, size_t cols,
+                       GEN &&gen) {
+  std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+  if (!out)
+    return false;
+
+  matrix_header_t h;
+  std::memcpy(h.magic, MATRIX_MAGIC, sizeof(h.magic));
+  h.rows = rows;
+  h.cols = cols;
+  h.elem_size = sizeof(T);
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+  std::vector<T> row(cols);
+  for (size_t r = 0; r < rows && out; ++r) {
+    for (size_t c = 0; c < cols; ++c)
+      row[c] = gen(r, c);
+    out.write(reinterpret_cast<const char *>(row.data()), cols * sizeof(T));
+  }
+  return static_cast<bool>(out);
+}
+
+// Map a matrix file of T elements and view it. false if the file cannot be
+// mapped, is not a matrix file, has elements of another size or is short.
+template <typename T>
+bool map_matrix_file(const std::string &fname, mapped_file &mf,
+                     matrix_view<T> &mv) {
+  // The probes of the peak finder jump around the file: no read-ahead.
+  if (!mf.open(fname, mapped_file::RANDOM))
+    return false;
+
+  if (mf.size() < sizeof(matrix_header_t))
+    return false;
+  matrix_header_t h;
+  std::memcpy(&h, mf.data(), sizeof(h));
+  if (std::memcmp(h.magic, MATRIX_MAGIC, sizeof(h.magic)) != 0 ||
+      h.elem_size != sizeof(T) || h.rows == 0 || h.cols == 0)
+    return false;
+  if (h.rows > (mf.size() - sizeof(h)) / sizeof(T) / h.cols)
+    return false;
+
+  // The header keeps the elements aligned for any T up to 32 bytes; the
+  // mapping itself is page aligned.
+  mv = matrix_view<T>(reinterpret_cast<const T *>(mf.data() + sizeof(h)),
+                      h.rows, h.cols);
+  return true;
+}
+
+struct peak_2d_t {
+  size_t row;
+  size_t col;
+  // Number of matrix cells read to find the peak.
+  uint64_t probes;
+};
+
+// Peak finding using divide and conquer on a window of the matrix, which
+// starts as the whole matrix.
+// Split the window along the middle of its longer side, so a square window
+// is split alternately by a column and by a row. Find the maximum of the
+// dividing line and look at its two neighbors across the line:
+// - if none is higher, the maximum is a peak;
+// - else the window shrinks to the half of the higher neighbor.
+// The window remembers the highest cell seen so far inside it (best). It is
+// at least as high as any cell just outside the window, so climbing from
+// it never leaves the window. If best is higher than the whole dividing
+// line, the window shrinks to the half of best instead.
+// Each line costs the length of the window side it spans and the window
+// halves on alternate sides, so the probes add up to O(rows + cols) cells,
+// a tiny fraction of a large matrix.
+template <typename T> peak_2d_t dc_2d_peak_finder(const matrix_view<T> &a) {
+  size_t r0 = 0, r1 = a.rows(), c0 = 0, c1 = a.cols();
+  bool has_best = false;
+  size_t br = 0, bc = 0;
+  uint64_t probes = 0;
+
+  while (true) {
+    if (c1 - c0 >= r1 - r0) {
+      // Split by the middle column.
+      const size_t c = c0 + (c1 - c0) / 2;
+      size_t r = r0;
+      for (size_t i = r0 + 1; i < r1; ++i)
+        if (a(i, c) > a(r, c))
+          r = i;
+      probes += r1 - r0;
+
+      if (has_best && a(br, bc) > a(r, c)) {
+        if (bc < c)
+          c1 = c;
+        else
+          c0 = c + 1;
+        continue;
+      }
+
+      probes += (c > c0) + (c + 1 < c1);
+      if (c > c0 && a(r, c - 1) > a(r, c)) {
+        br = r, bc = c - 1, has_best = true;
+        c1 = c;
+      } else if (c + 1 < c1 && a(r, c + 1) > a(r, c)) {
+        br = r, bc = c + 1, has_best = true;
+        c0 = c + 1;
+      } else {
+        return {r, c, probes};
+      }
+    } else {
+      // Split by the middle row.
+      const size_t r = r0 + (r1 - r0) / 2;
+      size_t c = c0;
+      for (size_t j = c0 + 1; j < c1; ++j)
+        if (a(r, j) > a(r, c))
+          c = j;
+      probes += c1 - c0;
+
+      if (has_best && a(br, bc) > a(r, c)) {
+        if (br < r)
+          r1 = r;
+        else
+          r0 = r + 1;
+        continue;
+      }
+
+      probes += (r > r0) + (r + 1 < r1);
+      if (r > r0 && a(r - 1, c) > a(r, c)) {
+        br = r - 1, bc = c, has_best = true;
+        r1 = r;
+      } else if (r + 1 < r1 && a(r + 1, c) > a(r, c)) {
+        br = r + 1, bc = c, has_best = true;
+        r0 = r + 1;
+      } else {
+        return {r, c, probes};
+      }
+    }
+  }
+}
+
+// Check that no neighbor of (r, c) is higher.
+template <typename T>
+bool is_2d_peak(const matrix_view<T> &a, size_t r, size_t c) {
+  const T &v = a(r, c);
+  return !((r > 0 && a(r - 1, c) > v) ||
+           (r + 1 < a.rows() && a(r + 1, c) > v) ||
+           (c > 0 && a(r, c - 1) > v) ||
+           (c + 1 < a.cols() && a(r, c + 1) > v));
+}
+
+// Write a rows x cols terrain with a single peak: a noisy cone whose every
+// step away from the summit goes down, at (peak_r, peak_c).
+bool write_cone_matrix_file(const std::string &fname, size_t rows,
+                            size_t cols, size_t &peak_r, size_t &peak_c) {
+  xoshiro256 rng(2147483647);
+  peak_r = rng.bounded(rows);
+  peak_c = rng.bounded(cols);
+
+  // A step changes the distance by 1, i.e. the height by 4, which the
+  // noise of [0, 3] cannot undo.
+  auto height = [&](size_t r, size_t c) {
+    const int64_t dist = ((r > peak_r) ? r - peak_r : peak_r - r) +
+                         ((c > peak_c) ? c - peak_c : peak_c - c);
+    return static_cast<int32_t>(INT32_MAX - 4 * dist - rng.bounded(4));
+  };
+  return write_matrix_file<int32_t>(fname, rows, cols, height);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 2) {
+    std::cout << "Usage: " << argv[0] << " [matrix_file]" << std::endl;
+    std::cout << "Without a matrix file, a 4096 x 4096 one is generated."
+              << std::endl;
+    return 1;
+  }
+
+  std::string fname;
+  bool generated = false;
+  size_t peak_r = 0, peak_c = 0;
+  if (argc == 2) {
+    fname = argv[1];
+  } else {
+    char tmpl[] = "/tmp/m006_01_04_XXXXXX";
+    const int fd = mkstemp(tmpl);
+    if (fd < 0) {
+      std::cout << "Cannot create a temporary file." << std::endl;
+      return 1;
+    }
+    close(fd);
+    fname = tmpl;
+    generated = true;
+
+    const size_t M = 4096, N = 4096;
+    std::cout << "Generating a " << M << " x " << N << " matrix in " << fname
+              << std::endl;
+    if (!write_cone_matrix_file(fname, M, N, peak_r, peak_c)) {
+      std::cout << "Cannot write " << fname << std::endl;
+      unlink(fname.c_str());
+      return 1;
+    }
+  }
+
+  mapped_file mf;
+  matrix_view<int32_t> a;
+  const bool mapped = map_matrix_file(fname, mf, a);
+  // The mapping stays valid after the name is gone.
+  if (generated)
+    unlink(fname.c_str());
+  if (!mapped) {
+    std::cout << "Cannot map " << fname << " as a matrix of int32_t"
+              << std::endl;
+    return 1;
+  }
+
+  exec_time et;
+  peak_2d_t p;
+  et([&]() { p = dc_2d_peak_finder(a); });
+
+  std::cout << "Divide and Conquer" << std::endl;
+  std::cout << p.row << ", " << p.col << " = " << a(p.row, p.col)
+            << std::endl;
+  std::cout << "Probed " << p.probes << " of " << a.rows() * a.cols()
+            << " cells in " << et.get() << " ms" << std::endl;
+
+  bool ok = is_2d_peak(a, p.row, p.col);
+  if (generated)
+    ok = ok && p.row == peak_r && p.col == peak_c;
+  if (!ok) {
+    std::cout << "Not a peak." << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,203 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "exec_time.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+
+// Find every peak of an array, not just one: element i is a peak if it is
+// not lower than any of its neighbors, as in linear_peak_finder.
+//
+// The result is a bitmask, bit i % 64 of word i / 64 set for a peak at i.
+// A word of the mask is computed by a kernel from 64 elements and their
+// two outer neighbors. The vector kernels compare 4 (SSE2) or 8 (AVX2)
+// elements at once with the same elements shifted by one to the left and
+// to the right, and turn the comparisons into mask bits without a branch.
+// The first and the last word, which miss a neighbor, go through the
+// scalar kernel.
+//
+// The array is split in chunks of whole mask words, which the threads of
+// a pool work on. A chunk reads the elements just outside it (the halo)
+// but writes only its own words, so the threads share no writes.
+
+enum peak_kernel_t { PEAK_SCALAR, PEAK_SSE2, PEAK_AVX2 };
+
+// Check if a[i] is a peak of a[0..n).
+inline bool is_peak(const int *a, size_t n, size_t i) {
+  return !((i > 0 && a[i] < a[i - 1]) || (i + 1 < n && a[i] < a[i + 1]));
+}
+
+// Mask of the peaks among a[base..base + 64) of a[0..n).
+inline uint64_t peak_word_scalar(const int *a, size_t n, size_t base) {
+  uint64_t m = 0;
+  const size_t end = std::min(n, base + 64);
+  for (size_t i = base; i < end; ++i)
+    m |= static_cast<uint64_t>(is_peak(a, n, i)) << (i - base);
+  return m;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Mask of the peaks among p[0..64); p[-1] and p[64] must be readable.
+__attribute__((target("sse2"))) inline uint64_t
+peak_word_sse2(const int *p) {
+  uint64_t lower = 0;
+  for (int k = 0; k < 64; k += 4) {
+    const __m128i cur = _mm_loadu_si128((const __m128i *)(p + k));
+    const __m128i left = _mm_loadu_si128((const __m128i *)(p + k - 1));
+    const __m128i right = _mm_loadu_si128((const __m128i *)(p + k + 1));
+    const __m128i lt = _mm_or_si128(_mm_cmpgt_epi32(left, cur),
+                                    _mm_cmpgt_epi32(right, cur));
+    const uint32_t bits = _mm_movemask_ps(_mm_castsi128_ps(lt));
+    lower |= static_cast<uint64_t>(bits) << k;
+  }
+  return ~lower;
+}
+
+__attribute__((target("avx2"))) inline uint64_t
+peak_word_avx2(const int *p) {
+  uint64_t lower = 0;
+  for (int k = 0; k < 64; k += 8) {
+    const __m256i cur = _mm256_loadu_si256((const __m256i *)(p + k));
+    const __m256i left = _mm256_loadu_si256((const __m256i *)(p + k - 1));
+    const __m256i right = _mm256_loadu_si256((const __m256i *)(p + k + 1));
+    const __m256i lt = _mm256_or_si256(_mm256_cmpgt_epi32(left, cur),
+                                       _mm256_cmpgt_epi32(right, cur));
+    const uint32_t bits = _mm256_movemask_ps(_mm256_castsi256_ps(lt));
+    lower |= static_cast<uint64_t>(bits) << k;
+  }
+  return ~lower;
+}
+#endif
+
+// The fastest kernel the CPU runs.
+inline peak_kernel_t best_peak_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx2"))
+    return PEAK_AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return PEAK_SSE2;
+#endif
+  return PEAK_SCALAR;
+}
+
+// Mask words [wb, we) of the peaks of a[0..n).
+template <peak_kernel_t K>
+void peak_words(const int *a, size_t n, size_t wb, size_t we, uint64_t *mask) {
+  for (size_t w = wb; w < we; ++w) {
+    const size_t base = w * 64;
+    if (K == PEAK_SCALAR || base == 0 || base + 64 >= n) {
+      mask[w] = peak_word_scalar(a, n, base);
+      continue;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    mask[w] = (K == PEAK_AVX2) ? peak_word_avx2(a + base)
+                               : peak_word_sse2(a + base);
+#endif
+  }
+}
+
+// Set mask to the peaks of a[0..n), chunks of the array in parallel on the
+// pool, if any.
+void all_peaks_finder(const int *a, size_t n, std::vector<uint64_t> &mask,
+                      thread_pool *pool = nullptr,
+                      peak_kernel_t kernel = best_peak_kernel()) {
+  // 256K elements a chunk.
+  const size_t CHUNK_WORDS = 4096;
+  const size_t words = (n + 63) / 64;
+  const size_t chunks = (words + CHUNK_WORDS - 1) / CHUNK_WORDS;
+  mask.resize(words);
+
+  uint64_t *m = mask.data();
+  parallel_for(pool, 0, chunks, 1, [&](size_t c) {
+    const size_t wb = c * CHUNK_WORDS;
+    const size_t we = std::min(words, wb + CHUNK_WORDS);
+    switch (kernel) {
+    case PEAK_AVX2:
+      peak_words<PEAK_AVX2>(a, n, wb, we, m);
+      break;
+    case PEAK_SSE2:
+      peak_words<PEAK_SSE2>(a, n, wb, we, m);
+      break;
+    case PEAK_SCALAR:
+    default:
+      peak_words<PEAK_SCALAR>(a, n, wb, we, m);
+      break;
+    }
+  });
+}
+
+size_t count_peaks(const std::vector<uint64_t> &mask) {
+  size_t count = 0;
+  for (auto w : mask)
+    count += __builtin_popcountll(w);
+  return count;
+}
+
+void print_peaks(const std::vector<uint64_t> &mask) {
+  for (size_t w = 0; w < mask.size(); ++w)
+    for (size_t b = 0; b < 64; ++b)
+      if ((mask[w] >> b) & 1)
+        std::cout << w * 64 + b << " ";
+  std::cout << std::endl;
+}
+
+int main() {
+  std::vector<uint64_t> mask;
+
+  std::vector<int> a1{0, 1, 2, 3, 4, 5, 6, 7};
+  all_peaks_finder(a1.data(), a1.size(), mask);
+  print_peaks(mask);
+
+  std::vector<int> a2{0, 1, 2, 3, 4, 3, 2, 1, 5, 5, 0, 7};
+  all_peaks_finder(a2.data(), a2.size(), mask);
+  print_peaks(mask);
+
+  std::vector<int> a3{7, 6, 5, 4, 3, 2, 1, 0};
+  all_peaks_finder(a3.data(), a3.size(), mask);
+  print_peaks(mask);
+  std::cout << std::endl;
+
+  // A large random signal with every kernel, sequential and on a pool. The
+  // masks must agree.
+  const size_t N = 1 << 24;
+  std::vector<int> a(N);
+  xoshiro256 rng(2147483647);
+  for (auto &x : a)
+    x = rng.bounded(1000);
+
+  const char *names[] = {"scalar", "sse2", "avx2"};
+  thread_pool pool;
+  std::vector<uint64_t> expected;
+  all_peaks_finder(a.data(), N, expected, nullptr, PEAK_SCALAR);
+  for (int k = PEAK_SCALAR; k <= best_peak_kernel(); ++k) {
+    for (auto *p : {static_cast<thread_pool *>(nullptr), &pool}) {
+      exec_time et;
+      et([&]() {
+        all_peaks_finder(a.data(), N, mask, p, static_cast<peak_kernel_t>(k));
+      });
+      std::cout << names[k] << (p ? ", pool" : "") << ": "
+                << count_peaks(mask) << " peaks of " << N << " in "
+                << et.get() << " ms" << std::endl;
+      if (mask != expected) {
+        std::cout << "Masks differ." << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
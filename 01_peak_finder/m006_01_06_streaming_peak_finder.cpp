@@ -0,0 +1,214 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "latency_histogram.hpp"
+#include "rng.hpp"
+
+// Peak finding over an unbounded stream of samples.
+//
+// A sample is a peak if it is not lower than any of its neighbors, as in
+// linear_peak_finder. Whether it is a peak is known once the next sample
+// arrives, so push() confirms the previous sample, one sample late;
+// finish() confirms the last one at the end of the stream.
+//
+// The confirmed peaks of the last 'window' samples are kept in a ring
+// buffer in stream order. They expire from the front as the window slides
+// on, so the state is O(window) and a push is O(1) amortized, whatever the
+// length of the stream. top_k() picks the k highest peaks of the window
+// with a min-heap bounded to k entries, in O(window * log(k)), without
+// allocating once the output has room for k peaks.
+template <typename T> class streaming_peak_finder {
+public:
+  struct peak_t {
+    // Position of the sample in the stream.
+    uint64_t index;
+    T value;
+  };
+
+private:
+  const size_t mWindow;
+
+  // Ring buffer of the peaks in the window, oldest at mHead.
+  std::vector<peak_t> mPeaks;
+  size_t mHead;
+  size_t mSize;
+
+  // Samples pushed so far, and the last two of them.
+  uint64_t mCount;
+  T mPrev2;
+  T mPrev;
+
+  // Drop the peaks which are not among the last mWindow samples.
+  void expire() {
+    while (mSize && mPeaks[mHead].index + mWindow < mCount) {
+      mHead = (mHead + 1 == mPeaks.size()) ? 0 : mHead + 1;
+      --mSize;
+    }
+  }
+
+  void add(const peak_t &p) {
+    if (p.index + mWindow < mCount)
+      return;
+    size_t tail = mHead + mSize;
+    if (tail >= mPeaks.size())
+      tail -= mPeaks.size();
+    mPeaks[tail] = p;
+    ++mSize;
+  }
+
+public:
+  explicit streaming_peak_finder(size_t window)
+      : mWindow(std::max<size_t>(window, 1)), mPeaks(mWindow), mHead(0),
+        mSize(0), mCount(0), mPrev2(), mPrev() {}
+
+  // Feed the next sample. Returns true, with the peak in p, if it confirms
+  // the previous sample as a peak.
+  bool push(const T &x, peak_t &p) {
+    bool confirmed = false;
+    if (mCount > 0) {
+      const uint64_t i = mCount - 1;
+      if (!((i > 0 && mPrev < mPrev2) || mPrev < x)) {
+        p = {i, mPrev};
+        confirmed = true;
+      }
+    }
+    mPrev2 = mPrev;
+    mPrev = x;
+    ++mCount;
+
+    // At most mWindow - 1 peaks remain, room for the new one.
+    expire();
+    if (confirmed)
+      add(p);
+    return confirmed;
+  }
+
+  // End of the stream: returns true, with the peak in p, if the last
+  // sample is a peak. Call it once.
+  bool finish(peak_t &p) {
+    if (mCount == 0)
+      return false;
+    const uint64_t i = mCount - 1;
+    if (i > 0 && mPrev < mPrev2)
+      return false;
+    p = {i, mPrev};
+    add(p);
+    return true;
+  }
+
+  // Set out to the k highest peaks of the window, highest first.
+  void top_k(size_t k, std::vector<peak_t> &out) const {
+    out.clear();
+    if (k == 0)
+      return;
+
+    // The front of a min-heap of the best k so far is the one to beat.
+    auto higher = [](const peak_t &a, const peak_t &b) {
+      return b.value < a.value;
+    };
+    for (size_t n = 0, i = mHead; n < mSize; ++n) {
+      const peak_t &p = mPeaks[i];
+      if (out.size() < k) {
+        out.push_back(p);
+        std::push_heap(out.begin(), out.end(), higher);
+      } else if (out.front().value < p.value) {
+        std::pop_heap(out.begin(), out.end(), higher);
+        out.back() = p;
+        std::push_heap(out.begin(), out.end(), higher);
+      }
+      i = (i + 1 == mPeaks.size()) ? 0 : i + 1;
+    }
+    std::sort_heap(out.begin(), out.end(), higher);
+  }
+
+  // Number of peaks in the window.
+  size_t size() const { return mSize; }
+
+  // Number of samples pushed.
+  uint64_t samples() const { return mCount; }
+};
+
+// The k highest peaks among samples (end - window, end) of s[0..end],
+// by brute force. Only the values are returned, highest first.
+std::vector<int> top_k_values(const std::vector<int> &s, size_t end,
+                              size_t window, size_t k) {
+  std::vector<int> values;
+  const size_t begin = (end + 1 > window) ? end + 1 - window : 0;
+  for (size_t i = begin; i < end; ++i)
+    if (!((i > 0 && s[i] < s[i - 1]) || s[i] < s[i + 1]))
+      values.push_back(s[i]);
+  std::sort(values.begin(), values.end(), std::greater<int>());
+  values.resize(std::min(values.size(), k));
+  return values;
+}
+
+int main() {
+  typedef streaming_peak_finder<int> finder_t;
+  finder_t::peak_t p;
+  std::vector<finder_t::peak_t> top;
+
+  // Peaks as they are confirmed, and the top 2 of the last 6 samples.
+  std::vector<int> a{0, 1, 2, 3, 4, 3, 2, 1, 5, 5, 0, 7};
+  finder_t f(6);
+  for (auto x : a)
+    if (f.push(x, p))
+      std::cout << "[" << p.index << "] = " << p.value << " ";
+  if (f.finish(p))
+    std::cout << "[" << p.index << "] = " << p.value;
+  std::cout << std::endl;
+  f.top_k(2, top);
+  for (const auto &t : top)
+    std::cout << "[" << t.index << "] = " << t.value << " ";
+  std::cout << std::endl << std::endl;
+
+  // A long stream: the latency of every push and of a top-k query after
+  // every WINDOW samples. The first samples are kept to check the queries
+  // by brute force.
+  const size_t N = 1 << 24, WINDOW = 1 << 12, K = 8, CHECKED = 1 << 18;
+  finder_t sf(WINDOW);
+  latency_histogram push_lat("push"), top_k_lat("top_k");
+  xoshiro256 rng(2147483647);
+  std::vector<int> kept;
+  top.reserve(K);
+
+  uint64_t peaks = 0;
+  bool ok = true;
+  for (size_t t = 0; t < N; ++t) {
+    const int x = rng.bounded(1 << 20);
+    peaks += push_lat.measure([&]() { return sf.push(x, p); });
+    if (t < CHECKED)
+      kept.push_back(x);
+
+    if ((t + 1) % WINDOW == 0) {
+      top_k_lat.measure([&]() { sf.top_k(K, top); });
+      if (t < CHECKED) {
+        const auto expected = top_k_values(kept, t, WINDOW, K);
+        ok = ok && (expected.size() == top.size());
+        for (size_t i = 0; ok && i < top.size(); ++i)
+          ok = (top[i].value == expected[i]);
+      }
+    }
+  }
+  peaks += sf.finish(p);
+
+  std::cout << N << " samples, " << peaks << " peaks, window " << WINDOW
+            << ", top " << K << std::endl;
+  std::cout << push_lat << top_k_lat << std::endl;
+
+  if (!ok) {
+    std::cout << "Top peaks differ." << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
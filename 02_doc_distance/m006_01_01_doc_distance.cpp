@@ -6,89 +6,591 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include <algorithm>
 #include <cmath>
-#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
 
 // Hash-map of word to frequency.
-typedef std::unordered_map<std::string, int> freq_table_t;
+//
+// Open addressing with linear probing over a power of two number of slots,
+// kept at most half full. A word is copied once, when it is first seen,
+// into an arena of large blocks owned by the table; the slots refer to it
+// with a string_view. Counting a word seen before does not allocate.
+//
+// The views point into the arena, so a table can be moved but not copied.
+class freq_table_t {
+public:
+  struct entry_t {
+    std::string_view word;
+    uint64_t hash;
+    // 0 for an empty slot.
+    uint64_t count;
+  };
+
+private:
+  enum { MIN_SLOTS = 64, BLOCK_SIZE = 1 << 16 };
+
+  std::vector<entry_t> mSlots;
+  size_t mSize;
+
+  std::vector<std::unique_ptr<char[]>> mBlocks;
+  // Free bytes at the end of the last block.
+  char *mFree;
+  size_t mFreeLen;
+
+  // Copy a word into the arena. Words longer than a block get a block of
+  // their own.
+  std::string_view intern(std::string_view w) {
+    if (w.size() > mFreeLen) {
+      const size_t len = std::max<size_t>(w.size(), BLOCK_SIZE);
+      mBlocks.emplace_back(new char[len]);
+      mFree = mBlocks.back().get();
+      mFreeLen = len;
+    }
+    std::memcpy(mFree, w.data(), w.size());
+    const std::string_view iw(mFree, w.size());
+    mFree += w.size();
+    mFreeLen -= w.size();
+    return iw;
+  }
+
+  size_t slot_of(std::string_view w, uint64_t h) const {
+    const size_t mask = mSlots.size() - 1;
+    size_t i = h & mask;
+    while (mSlots[i].count && !(mSlots[i].hash == h && mSlots[i].word == w))
+      i = (i + 1) & mask;
+    return i;
+  }
+
+  void grow() {
+    std::vector<entry_t> old(mSlots.size() * 2, entry_t{{}, 0, 0});
+    old.swap(mSlots);
+    for (const auto &e : old)
+      if (e.count)
+        mSlots[slot_of(e.word, e.hash)] = e;
+  }
+
+public:
+  freq_table_t()
+      : mSlots(MIN_SLOTS, entry_t{{}, 0, 0}), mSize(0), mFree(nullptr),
+        mFreeLen(0) {}
+
+  freq_table_t(const freq_table_t &) = delete;
+  freq_table_t &operator=(const freq_table_t &) = delete;
+  // A moved-from table is empty.
+  freq_table_t(freq_table_t &&other) : freq_table_t() { swap(other); }
+
+  freq_table_t &operator=(freq_table_t &&other) {
+    swap(other);
+    return *this;
+  }
+
+  void swap(freq_table_t &other) {
+    mSlots.swap(other.mSlots);
+    std::swap(mSize, other.mSize);
+    mBlocks.swap(other.mBlocks);
+    std::swap(mFree, other.mFree);
+    std::swap(mFreeLen, other.mFreeLen);
+  }
+
+  // FNV-1a, a character at a time for the callers that hash a word while
+  // they put it together.
+  static constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+
+  static uint64_t hash_step(uint64_t h, char c) {
+    return (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+  }
+
+  static uint64_t hash(std::string_view w) {
+    uint64_t h = HASH_SEED;
+    for (char c : w)
+      h = hash_step(h, c);
+    return h;
+  }
+
+  // Add n to the count of a word of hash h.
+  void add(std::string_view w, uint64_t h, uint64_t n = 1) {
+    size_t i = slot_of(w, h);
+    if (!mSlots[i].count) {
+      if (2 * (mSize + 1) > mSlots.size()) {
+        grow();
+        i = slot_of(w, h);
+      }
+      mSlots[i] = entry_t{intern(w), h, 0};
+      ++mSize;
+    }
+    mSlots[i].count += n;
+  }
+
+  void add(std::string_view w) { add(w, hash(w)); }
+
+  // Add the counts of another table, which is left empty. The smaller of
+  // the two is added to the bigger one.
+  void merge(freq_table_t &&other) {
+    if (other.mSize > mSize)
+      swap(other);
+    other.for_each([&](const entry_t &e) { add(e.word, e.hash, e.count); });
+    other.clear();
+  }
+
+  // Count of a word of hash h; 0 if absent.
+  uint64_t find(std::string_view w, uint64_t h) const {
+    return mSlots[slot_of(w, h)].count;
+  }
+
+  uint64_t find(std::string_view w) const { return find(w, hash(w)); }
+
+  // Call f(entry) for every word in the table.
+  template <typename F> void for_each(F &&f) const {
+    for (const auto &e : mSlots)
+      if (e.count)
+        f(e);
+  }
+
+  // Number of distinct words.
+  size_t size() const { return mSize; }
+
+  // Forget all the words; the arena keeps its first block.
+  void clear() {
+    mSlots.assign(MIN_SLOTS, entry_t{{}, 0, 0});
+    mSize = 0;
+    if (!mBlocks.empty()) {
+      mBlocks.resize(1);
+      mFree = mBlocks[0].get();
+      mFreeLen = BLOCK_SIZE;
+    }
+  }
+};
 
 // Dumps a frequency table to ostream.
 std::ostream &operator<<(std::ostream &os, const freq_table_t &ft) {
-  for (auto &p : ft)
-    os << p.first << " : " << p.second << std::endl;
+  ft.for_each([&](const freq_table_t::entry_t &e) {
+    os << e.word << " : " << e.count << std::endl;
+  });
   return os;
 }
 
-// Extracts words from a string, converts to lowercase and
+// Lowercase of the alpha-numeric ASCII characters, 0 for the rest, which
+// separate words. As std::isalnum and tolower in the "C" locale.
+struct word_char_table {
+  char lower[256];
+
+  word_char_table() {
+    for (int c = 0; c < 256; ++c)
+      lower[c] = 0;
+    for (int c = '0'; c <= '9'; ++c)
+      lower[c] = c;
+    for (int c = 'a'; c <= 'z'; ++c)
+      lower[c] = lower[c - 'a' + 'A'] = c;
+  }
+};
+
+static const word_char_table WORD_CHARS;
+
+// Splits text into words, views of the text itself.
+class word_tokenizer {
+private:
+  const char *mPos;
+  const char *mEnd;
+
+public:
+  // Lowercase of c if it belongs to words, else 0.
+  static char lower(char c) {
+    return WORD_CHARS.lower[static_cast<unsigned char>(c)];
+  }
+
+  explicit word_tokenizer(std::string_view text)
+      : mPos(text.data()), mEnd(text.data() + text.size()) {}
+
+  // Next word, as it appears in the text; false at the end of the text.
+  bool next(std::string_view &word) {
+    while (mPos < mEnd && !lower(*mPos))
+      ++mPos;
+    if (mPos == mEnd)
+      return false;
+    const char *begin = mPos;
+    while (mPos < mEnd && lower(*mPos))
+      ++mPos;
+    word = std::string_view(begin, mPos - begin);
+    return true;
+  }
+
+  // Lowercase word into buf, which must have room for it; the hash of the
+  // lowercase word.
+  static uint64_t to_lower(std::string_view word, char *buf) {
+    uint64_t h = freq_table_t::HASH_SEED;
+    for (size_t i = 0; i < word.size(); ++i) {
+      buf[i] = lower(word[i]);
+      h = freq_table_t::hash_step(h, buf[i]);
+    }
+    return h;
+  }
+};
+
+// Bytes of text counted by one task of the thread pool, at least.
+const size_t COUNT_GRAIN = 1 << 20;
+
+// Extracts words from a text, converts to lowercase and
 // adds to its count in the frequency table.
-void count_word_frequency(const std::string str, freq_table_t &ft) {
-  std::string word;
-
-  for (std::string::size_type i = 0; i < str.length(); ++i) {
-    if (std::isalnum(str.at(i))) {
-      word.push_back(static_cast<char>(tolower(str.at(i))));
-    } else if (!word.empty()) { // Non-alpha-numeric; end of current word.
-      ++ft[word];
-      word.clear();
+// With a thread pool, the text is halved at a word boundary near the
+// middle, recursively, down to COUNT_GRAIN bytes. The halves are counted
+// into tables of their own on tasks of the pool, and the right table is
+// merged into the left one on the way back: a tree of merges, as deep as
+// the recursion, instead of one table shared by the threads.
+void count_word_frequency(std::string_view text, freq_table_t &ft,
+                          thread_pool *pool = nullptr) {
+  if (pool && text.size() > COUNT_GRAIN) {
+    size_t mid = text.size() / 2;
+    while (mid < text.size() && word_tokenizer::lower(text[mid]))
+      ++mid;
+    // Not a single word across the whole right half.
+    if (mid < text.size()) {
+      freq_table_t right;
+      parallel_invoke(
+          pool,
+          [&]() { count_word_frequency(text.substr(0, mid), ft, pool); },
+          [&]() { count_word_frequency(text.substr(mid), right, pool); });
+      ft.merge(std::move(right));
+      return;
     }
   }
 
-  // Last word
-  if (!word.empty()) {
-    ++ft[word];
-    word.clear();
+  // Lowercase words are put together here; it only grows for a word
+  // longer than any before.
+  std::vector<char> buf(64);
+
+  word_tokenizer tok(text);
+  std::string_view word;
+  while (tok.next(word)) {
+    if (word.size() > buf.size())
+      buf.resize(2 * word.size());
+    const uint64_t h = word_tokenizer::to_lower(word, buf.data());
+    ft.add(std::string_view(buf.data(), word.size()), h);
   }
 }
 
-// Reads a flie line-by-line, extracts words from each line and updates
-// their frequency in frequency table.
-void count_file_word_frequency(const std::string &fname, freq_table_t &ft) {
-  std::ifstream infile(fname);
-  std::string line;
-  while (std::getline(infile, line)) {
-    count_word_frequency(line, ft);
-  }
+// Maps a file and counts the frequency of its words in place, without
+// copying the text; false if the file cannot be mapped.
+bool count_file_word_frequency(const std::string &fname, freq_table_t &ft,
+                               thread_pool *pool = nullptr) {
+  mapped_file mf;
+  if (!mf.open(fname, mapped_file::SEQUENTIAL))
+    return false;
+  count_word_frequency(std::string_view(mf.data(), mf.size()), ft, pool);
+  return true;
 }
 
-// Inner product of two frequency tables.
+// Inner product of two frequency tables. The words of the smaller one are
+// looked up in the other.
 double inner_product(const freq_table_t &f1, const freq_table_t &f2) {
+  if (f1.size() > f2.size())
+    return inner_product(f2, f1);
+
   double sum = 0.0;
-  for (const auto &p : f1) {
-    const auto i = f2.find(p.first);
-    if (i != f2.end()) {
-      sum += (p.second * i->second);
-    }
-  }
+  f1.for_each([&](const freq_table_t::entry_t &e) {
+    sum += static_cast<double>(e.count) * f2.find(e.word, e.hash);
+  });
 
   return sum;
 }
 
+// Angle of two frequency tables, given the inner products of each table
+// with itself. An empty document is taken as orthogonal to any other.
+double vector_angle(const freq_table_t &f1, double ff1,
+                    const freq_table_t &f2, double ff2) {
+  if (ff1 == 0.0 || ff2 == 0.0)
+    return M_PI / 2;
+  auto numerator = inner_product(f1, f2);
+  auto denominator = std::sqrt(ff1 * ff2);
+  // Rounding can take the ratio of identical documents just above 1.
+  return std::acos(std::min(1.0, numerator / denominator));
+}
+
 // Angle of two frequency tables.
 double vector_angle(const freq_table_t &f1, const freq_table_t &f2) {
-  auto numerator = inner_product(f1, f2);
-  auto denominator = std::sqrt(inner_product(f1, f1) * inner_product(f2, f2));
-  // std::cout << numerator << "/" << denominator << std::endl;
-  return std::acos(numerator / denominator);
+  return vector_angle(f1, inner_product(f1, f1), f2, inner_product(f2, f2));
 }
 
-int main(int argc, char *argv[]) {
-  if (argc != 3) {
-    std::cerr << "Usage: " << argv[0] << " file1 file2" << std::endl;
-    return 1;
+// Corpus mode: the angles between every two documents of a corpus.
+//
+// Every word of the corpus is given an integer id, and a document becomes
+// a sparse vector: the ids of its words, sorted, with their counts and
+// the norm of the vector. The inner product of two documents is a merge
+// of their id lists, without hashing a word.
+// The documents are compared a block against a block, so that the
+// vectors of both blocks stay in cache for all the pairs across them; the
+// blocks of rows are spread over a thread pool.
+
+// Ids of the words of a corpus: the first word seen gets 0, the next new
+// one 1, and so on.
+class word_ids_t {
+private:
+  // Id + 1 of a word, as its count.
+  freq_table_t mIds;
+
+public:
+  uint32_t id(const freq_table_t::entry_t &e) {
+    const uint64_t v = mIds.find(e.word, e.hash);
+    if (v)
+      return static_cast<uint32_t>(v - 1);
+    mIds.add(e.word, e.hash, mIds.size() + 1);
+    return static_cast<uint32_t>(mIds.size() - 1);
+  }
+
+  size_t size() const { return mIds.size(); }
+};
+
+// A document as a sparse vector of word counts.
+struct doc_vector_t {
+  // Increasing word ids.
+  std::vector<uint32_t> ids;
+  std::vector<double> counts;
+  double norm;
+};
+
+// Turn the frequency tables of the documents into vectors over the ids of
+// the words of all of them. The tables are emptied on the way.
+void make_doc_vectors(std::vector<freq_table_t> &tables,
+                      std::vector<doc_vector_t> &docs,
+                      thread_pool *pool = nullptr) {
+  docs.resize(tables.size());
+
+  // The ids have to be handed out in one order, one document after the
+  // other.
+  word_ids_t ids;
+  std::vector<std::vector<std::pair<uint32_t, double>>> words(tables.size());
+  for (size_t d = 0; d < tables.size(); ++d) {
+    words[d].reserve(tables[d].size());
+    tables[d].for_each([&](const freq_table_t::entry_t &e) {
+      words[d].emplace_back(ids.id(e), static_cast<double>(e.count));
+    });
+    tables[d].clear();
+  }
+
+  parallel_for(pool, 0, docs.size(), 1, [&](size_t d) {
+    auto &w = words[d];
+    std::sort(w.begin(), w.end());
+    doc_vector_t &doc = docs[d];
+    doc.ids.resize(w.size());
+    doc.counts.resize(w.size());
+    double nn = 0.0;
+    for (size_t i = 0; i < w.size(); ++i) {
+      doc.ids[i] = w[i].first;
+      doc.counts[i] = w[i].second;
+      nn += w[i].second * w[i].second;
+    }
+    doc.norm = std::sqrt(nn);
+    std::vector<std::pair<uint32_t, double>>().swap(w);
+  });
+}
+
+// Inner product of two documents: a merge of their sorted ids. Each step
+// advances one or both lists by adding the results of the comparisons,
+// rather than branching on which list is behind; only a match branches.
+double inner_product(const doc_vector_t &a, const doc_vector_t &b) {
+  const size_t na = a.ids.size(), nb = b.ids.size();
+  double sum = 0.0;
+  size_t i = 0, j = 0;
+  while (i < na && j < nb) {
+    const uint32_t x = a.ids[i], y = b.ids[j];
+    if (x == y)
+      sum += a.counts[i] * b.counts[j];
+    i += (x <= y);
+    j += (y <= x);
   }
+  return sum;
+}
+
+// Angle of two documents. An empty document shares no word with any
+// other, so it is put at a right angle to all of them, instead of the NaN
+// of a zero norm. Rounding may take the cosine of a document and itself
+// just above 1.
+double vector_angle(const doc_vector_t &a, const doc_vector_t &b) {
+  if (a.norm == 0.0 || b.norm == 0.0)
+    return M_PI / 2;
+  return std::acos(std::min(1.0, inner_product(a, b) / (a.norm * b.norm)));
+}
+
+// Documents in a block of the all-pairs loops.
+const size_t CORPUS_BLOCK = 64;
+
+// Set angles[i * n + j] to the angle between documents i and j of n.
+// A task takes a block of rows and fills it and its mirror image from the
+// diagonal on; the tasks write to different cells.
+void all_pairs_angles(const std::vector<doc_vector_t> &docs,
+                      std::vector<double> &angles,
+                      thread_pool *pool = nullptr) {
+  const size_t n = docs.size();
+  const size_t blocks = (n + CORPUS_BLOCK - 1) / CORPUS_BLOCK;
+  angles.assign(n * n, 0.0);
 
+  parallel_for(pool, 0, blocks, 1, [&](size_t bi) {
+    const size_t ib = bi * CORPUS_BLOCK, ie = std::min(n, ib + CORPUS_BLOCK);
+    for (size_t jb = ib; jb < n; jb += CORPUS_BLOCK) {
+      const size_t je = std::min(n, jb + CORPUS_BLOCK);
+      for (size_t i = ib; i < ie; ++i)
+        for (size_t j = std::max(jb, i + 1); j < je; ++j)
+          angles[i * n + j] = angles[j * n + i] =
+              vector_angle(docs[i], docs[j]);
+    }
+  });
+}
+
+struct neighbor_t {
+  uint32_t doc;
+  double angle;
+};
+
+// Set nn[i] to the k documents nearest to document i, nearest first.
+// A task takes a block of rows and compares each of them with every other
+// document, block by block, keeping the nearest k of a row in a max-heap
+// bounded to k entries. Every pair is compared twice, but no task writes
+// to the rows of another.
+void nearest_neighbors(const std::vector<doc_vector_t> &docs, size_t k,
+                       std::vector<std::vector<neighbor_t>> &nn,
+                       thread_pool *pool = nullptr) {
+  const size_t n = docs.size();
+  const size_t blocks = (n + CORPUS_BLOCK - 1) / CORPUS_BLOCK;
+  nn.assign(n, std::vector<neighbor_t>());
+
+  auto nearer = [](const neighbor_t &a, const neighbor_t &b) {
+    return a.angle < b.angle;
+  };
+  parallel_for(pool, 0, blocks, 1, [&](size_t bi) {
+    const size_t ib = bi * CORPUS_BLOCK, ie = std::min(n, ib + CORPUS_BLOCK);
+    for (size_t i = ib; i < ie; ++i)
+      nn[i].reserve(k);
+    for (size_t jb = 0; jb < n && k; jb += CORPUS_BLOCK) {
+      const size_t je = std::min(n, jb + CORPUS_BLOCK);
+      for (size_t i = ib; i < ie; ++i) {
+        auto &heap = nn[i];
+        for (size_t j = jb; j < je; ++j) {
+          if (j == i)
+            continue;
+          const neighbor_t nb{static_cast<uint32_t>(j),
+                              vector_angle(docs[i], docs[j])};
+          if (heap.size() < k) {
+            heap.push_back(nb);
+            std::push_heap(heap.begin(), heap.end(), nearer);
+          } else if (nb.angle < heap.front().angle) {
+            std::pop_heap(heap.begin(), heap.end(), nearer);
+            heap.back() = nb;
+            std::push_heap(heap.begin(), heap.end(), nearer);
+          }
+        }
+      }
+    }
+    for (size_t i = ib; i < ie; ++i)
+      std::sort_heap(nn[i].begin(), nn[i].end(), nearer);
+  });
+}
+
+// Angle of two files.
+int two_files_mode(const char *fname1, const char *fname2) {
+  // Both files are counted at once on the pool. Each task goes on to the
+  // inner product of its table with itself, so only the one across the
+  // tables is left once both are done.
+  thread_pool pool;
   freq_table_t ft1, ft2;
-  count_file_word_frequency(argv[1], ft1);
-  count_file_word_frequency(argv[2], ft2);
+  double ff1 = 0.0, ff2 = 0.0;
+  bool ok1 = false, ok2 = false;
+  parallel_invoke(
+      &pool,
+      [&]() {
+        ok1 = count_file_word_frequency(fname1, ft1, &pool);
+        ff1 = inner_product(ft1, ft1);
+      },
+      [&]() {
+        ok2 = count_file_word_frequency(fname2, ft2, &pool);
+        ff2 = inner_product(ft2, ft2);
+      });
+  if (!ok1 || !ok2) {
+    std::cerr << "Cannot read " << (ok1 ? fname2 : fname1) << std::endl;
+    return 1;
+  }
   // std::cout << "ft1: " << std::endl << ft1 << std::endl;
   // std::cout << "ft2: " << std::endl << ft2 << std::endl;
 
-  double angle = vector_angle(ft1, ft2);
+  double angle = vector_angle(ft1, ff1, ft2, ff2);
 
   std::cout << angle << std::endl;
 
   return 0;
 }
+
+// Angles between every two files, or the k nearest files of every file
+// if k > 0.
+int corpus_mode(const std::vector<std::string> &fnames, size_t k) {
+  thread_pool pool;
+  const size_t n = fnames.size();
+
+  std::vector<freq_table_t> tables(n);
+  std::vector<char> ok(n);
+  parallel_for(&pool, 0, n, 1, [&](size_t d) {
+    ok[d] = count_file_word_frequency(fnames[d], tables[d], &pool);
+  });
+  for (size_t d = 0; d < n; ++d) {
+    if (!ok[d]) {
+      std::cerr << "Cannot read " << fnames[d] << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<doc_vector_t> docs;
+  make_doc_vectors(tables, docs, &pool);
+
+  std::cout << std::fixed << std::setprecision(6);
+  if (k) {
+    std::vector<std::vector<neighbor_t>> nn;
+    nearest_neighbors(docs, k, nn, &pool);
+    for (size_t i = 0; i < n; ++i) {
+      std::cout << fnames[i] << ":";
+      for (const auto &nb : nn[i])
+        std::cout << " " << fnames[nb.doc] << " " << nb.angle;
+      std::cout << std::endl;
+    }
+  } else {
+    std::vector<double> angles;
+    all_pairs_angles(docs, angles, &pool);
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < n; ++j)
+        std::cout << angles[i * n + j] << ((j + 1 < n) ? " " : "");
+      std::cout << std::endl;
+    }
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  const std::string corpus("--corpus");
+  if (argc >= 2 && argv[1] == corpus) {
+    int first = 2;
+    size_t k = 0;
+    if (argc >= 4 && std::string(argv[2]) == "-k") {
+      k = std::strtoul(argv[3], nullptr, 10);
+      first = 4;
+    }
+    if (first < argc)
+      return corpus_mode(std::vector<std::string>(argv + first, argv + argc),
+                         k);
+  } else if (argc == 3) {
+    return two_files_mode(argv[1], argv[2]);
+  }
+
+  std::cerr << "Usage: " << argv[0] << " file1 file2" << std::endl;
+  std::cerr << "       " << argv[0] << " --corpus [-k k] file..." << std::endl;
+  return 1;
+}
@@ -6,7 +6,14 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
+
+#include "bench_baseline.hpp"
+#include "benchmark.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
 
 // Merge routine: merges two sorted arrays A and B into a third
 // sorted array C.
@@ -25,21 +32,30 @@ void merge(int *A, int m, int *B, int n, int *C) {
     C[k++] = B[j++];
 }
 
+// Elements merged by one task of the thread pool, at least.
+#define MERGE_GRAIN 8192
+
 // Iterative merge sort using 2-way merge.
-void two_way_merge_sort(int *arr, int n) {
-  int aux[n];
-  int *cur = arr, *nxt = aux;
+// The merges of one pass are independent of each other: given a thread
+// pool, they are spread over its workers, a few small merges per task in
+// the early passes.
+void two_way_merge_sort(int *arr, int n, thread_pool *pool = nullptr) {
+  std::vector<int> aux(n);
+  int *cur = arr, *nxt = aux.data();
 
   // Start with merging sub-arrays of size 1.
   // At each iteration double the size of input sub-arrays.
   // The array used as the input array at one iteration
   // becomes the output array in the next and vice versa.
   for (int step = 1; step < n; step *= 2) {
-    for (int i = 0; i < n; i += 2 * step) {
+    const size_t num_merges = (n + 2 * step - 1) / (2 * step);
+    const size_t grain = std::max(MERGE_GRAIN / (2 * step), 1);
+    parallel_for(pool, 0, num_merges, grain, [=](size_t m) {
+      const int i = 2 * step * m;
       merge(cur + i, ((i + step < n) ? step : n - i),                   // A, m
             cur + i + step, ((i + 2 * step < n) ? step : n - i - step), // B, n
             nxt + i);                                                   // C
-    }
+    });
 
     // Swap the current and next arrays.
     int *tmp = cur;
@@ -63,5 +79,40 @@ int main() {
     std::cout << i << " ";
   std::cout << std::endl;
 
-  return 0;
+  // Sort 2^22 random integers with and without a thread pool.
+  const int N = 1 << 22;
+  std::vector<int> input(N);
+  xoshiro256 rng;
+  for (auto &x : input)
+    x = rng.next32() >> 1;
+
+  thread_pool pool;
+  std::vector<int> sorted = input, psorted = input;
+  two_way_merge_sort(sorted.data(), N);
+  two_way_merge_sort(psorted.data(), N, &pool);
+  if (!std::is_sorted(sorted.begin(), sorted.end()) || psorted != sorted) {
+    std::cout << "Merge sort failed." << std::endl;
+    return 1;
+  }
+
+  std::cout << "Merge sort of " << N << " integers, " << pool.size()
+            << " threads" << std::endl;
+  benchmark bm(benchmark::config_t(1, 5));
+  bench_baseline bl;
+  std::vector<int> work;
+  bl.add(bm.run("two_way_merge_sort",
+                [&]() {
+                  work = input;
+                  two_way_merge_sort(work.data(), N);
+                }),
+         N);
+  bl.add(bm.run("two_way_merge_sort, pool",
+                [&]() {
+                  work = input;
+                  two_way_merge_sort(work.data(), N, &pool);
+                }),
+         N);
+  bm.print(std::cout);
+
+  return bl.finish_from_env(std::cout) ? 1 : 0;
 }
@@ -9,6 +9,8 @@
 #include <functional>
 #include <iostream>
 
+#include "event_counters.hpp"
+
 #define WDTH 16
 
 // AVL Tree, a height balanced BST.
@@ -172,6 +174,7 @@ private:
   // Left rotate subtree rooted at x and return new root of the subtree after
   // rotation.
   Node *left_rotate(Node *x) {
+    COUNT_EVENT("avl.left_rotations");
     Node *y = x->right;
     Node *B = y->left;
 
@@ -192,6 +195,7 @@ private:
   // Right rotate subtree rooted at x and return new root of the subtree after
   // rotation.
   Node *right_rotate(Node *x) {
+    COUNT_EVENT("avl.right_rotations");
     Node *y = x->left;
     Node *B = y->right;
 
@@ -11,6 +11,9 @@
 #include <list>
 #include <vector>
 
+#include "latency_histogram.hpp"
+#include "rng.hpp"
+
 // Hash Function Interface:
 // The concrete implementation of the function opertaor should
 // map an input 'key' into an integer  value [0 ... M) where
@@ -76,9 +79,9 @@ class UniversalHashFunction : public HashFunction {
 public:
   explicit UniversalHashFunction(uint32_t m)
       : HashFunction(m), P(least_prime_larger_than(m)) {
-    srand(P);
-    A = rand() % P;
-    B = rand() % P;
+    xoshiro256 rng(P);
+    A = rng.bounded(P);
+    B = rng.bounded(P);
   }
 
   virtual uint32_t operator()(uint32_t key) const override {
@@ -166,28 +169,34 @@ protected:
 
 int main() {
   const uint32_t N = 60;
-  srand(2147483647);
+  xoshiro256x4 rng(2147483647);
   uint32_t nums[N];
-  for (uint32_t i = 0; i < N; ++i)
-    nums[i] = rand();
+  // [0, RAND_MAX], as rand() gave.
+  rng.fill_bounded(nums, N, RAND_MAX + 1u);
 
   std::cout << "Division: " << std::endl;
   HashingWithChaining<DivisionHashFunction> divHash(N);
+  latency_histogram divHash_lat("insert");
   for (uint32_t i = 0; i < N; ++i)
-    divHash.insert(nums[i]);
+    divHash_lat.measure([&]() { divHash.insert(nums[i]); });
   divHash.dump(std::cout);
+  std::cout << divHash_lat;
 
   std::cout << std::endl << "Multiplication: " << std::endl;
   HashingWithChaining<MultiplicationHashFunction> multHash(N);
+  latency_histogram multHash_lat("insert");
   for (uint32_t i = 0; i < N; ++i)
-    multHash.insert(nums[i]);
+    multHash_lat.measure([&]() { multHash.insert(nums[i]); });
   multHash.dump(std::cout);
+  std::cout << multHash_lat;
 
   std::cout << std::endl << "Universal: " << std::endl;
   HashingWithChaining<UniversalHashFunction> uHash(N);
+  latency_histogram uHash_lat("insert");
   for (uint32_t i = 0; i < N; ++i)
-    uHash.insert(nums[i]);
+    uHash_lat.measure([&]() { uHash.insert(nums[i]); });
   uHash.dump(std::cout);
+  std::cout << uHash_lat;
 
   return 0;
 }
@@ -11,7 +11,10 @@
 #include <list>
 #include <vector>
 
-#define A_BIG_PRIME_NUMBER 2147483647 // srand seed
+#include "latency_histogram.hpp"
+#include "rng.hpp"
+
+#define A_BIG_PRIME_NUMBER 2147483647 // Random number generator seed
 
 // Hash Function Interface:
 // The concrete implementation of the function opertaor should
@@ -82,8 +85,8 @@ protected:
 class UniversalHashFunction : public HashFunction {
 
 public:
-  explicit UniversalHashFunction(uint32_t m) : HashFunction(m) {
-    srand(A_BIG_PRIME_NUMBER);
+  explicit UniversalHashFunction(uint32_t m)
+      : HashFunction(m), rng(A_BIG_PRIME_NUMBER) {
     UniversalHashFunction::OnHashSizeChange();
   }
 
@@ -94,8 +97,8 @@ public:
 protected:
   virtual void OnHashSizeChange() override {
     P = least_prime_larger_than(M);
-    A = rand() % P;
-    B = rand() % P;
+    A = rng.bounded(P);
+    B = rng.bounded(P);
   }
 
   static bool is_prime(uint32_t n) {
@@ -137,6 +140,8 @@ protected:
   uint32_t A; // Random number between 0 and (P - 1)
 
   uint32_t B; // Random number between 0 and (P - 1)
+
+  xoshiro256 rng; // Source of A and B
 };
 
 // Implements hashing with chaining
@@ -258,19 +263,23 @@ void run_test(const char *msg, uint32_t *nums, uint32_t N) {
   std::cout << msg << ":" << std::endl;
   HashTable<HASHFUNC> ht;
 
+  // Per-operation latencies.
+  latency_histogram insert_lat("insert"), find_lat("find"),
+      remove_lat("remove");
+
   // Insert N numbers into hash table.
   for (uint32_t i = 0; i < N; ++i)
-    ht.insert(nums[i]);
+    insert_lat.measure([&]() { ht.insert(nums[i]); });
 
   // All the N numbers should be found in the hash table.
   for (uint32_t i = 0; i < N; ++i)
-    if (nums[i] != ht.find(nums[i]))
+    if (nums[i] != find_lat.measure([&]() { return ht.find(nums[i]); }))
       std::cout << msg << ": Error: Not found: " << i << ":" << nums[i]
                 << std::endl;
 
   // Remove all numbers from the hash table except the last 2.
   for (uint32_t i = 0; i < N - 2; ++i)
-    ht.remove(nums[i]);
+    remove_lat.measure([&]() { ht.remove(nums[i]); });
 
   // The removed numbers should not be present in the hash table.
   for (uint32_t i = 0; i < N - 2; ++i)
@@ -281,14 +290,16 @@ void run_test(const char *msg, uint32_t *nums, uint32_t N) {
   // Print the hash table, it should be shrunk back to min length.
   ht.dump(std::cout);
   std::cout << std::endl;
+
+  std::cout << insert_lat << find_lat << remove_lat << std::endl;
 }
 
 int main() {
   const uint32_t N = 1000000; // A million
-  srand(A_BIG_PRIME_NUMBER);
+  xoshiro256x4 rng(A_BIG_PRIME_NUMBER);
   uint32_t nums[N];
-  for (uint32_t i = 0; i < N; ++i)
-    nums[i] = rand();
+  // [0, RAND_MAX], as rand() gave.
+  rng.fill_bounded(nums, N, RAND_MAX + 1u);
 
   run_test<DivisionHashFunction>("Division", nums, N);
   run_test<MultiplicationHashFunction>("Multiplication", nums, N);
@@ -10,6 +10,8 @@
 #include <iostream>
 #include <string>
 
+#include "event_counters.hpp"
+
 #define A_BIG_PRIME_NUMBER 2147483647 // srand seed
 
 namespace karp_rabin_util {
@@ -175,11 +177,13 @@ int32_t karp_rabin_strstr(const std::string &needle,
   auto false_positives = 0;
   for (auto j = needle.length();; ++j) {
     if (rh() == nh) {
+      COUNT_EVENT("karp_rabin.hash_matches");
       // Hashes match, compare the actual characters to confirm.
       if (haystack.compare(j - needle.length(), needle.length(), needle) == 0) {
         idx = j - needle.length();
         break;
       } else {
+        COUNT_EVENT("karp_rabin.false_positives");
         ++false_positives;
       }
     }
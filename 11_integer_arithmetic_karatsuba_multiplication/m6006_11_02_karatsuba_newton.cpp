@@ -9,6 +9,11 @@
 #include <iostream>
 #include <vector>
 
+#include "exec_time.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+
 // Namespace providing utilities and definitions for manipulating the magnitude
 // of large numbers.
 namespace magn {
@@ -276,11 +281,17 @@ magnitude_t dc_multiply(const magnitude_t &lhs, const magnitude_t &rhs) {
   return dc_multiply_recurse(lhs, rhs, 0, lhs.size() - 1, 0, rhs.size() - 1);
 }
 
-magnitude_t karatsuba_multiply(const magnitude_t &lhs, const magnitude_t &rhs);
+// Operand size, in words, from which the three sub-products of Karatsuba
+// are computed in parallel when a thread pool is given.
+const size_t KARATSUBA_PARALLEL_WORDS = 128;
+
+magnitude_t karatsuba_multiply(const magnitude_t &lhs, const magnitude_t &rhs,
+                               thread_pool *pool = nullptr);
 
 magnitude_t karatsuba_multiply_recurse(const magnitude_t &lhs,
                                        const magnitude_t &rhs, size_t ll,
-                                       size_t lh, size_t rl, size_t rh) {
+                                       size_t lh, size_t rl, size_t rh,
+                                       thread_pool *pool = nullptr) {
   if (ll > lh || rl > rh || ll >= lhs.size() || rl >= rhs.size()) {
     return magnitude_t();
   }
@@ -312,19 +323,33 @@ magnitude_t karatsuba_multiply_recurse(const magnitude_t &lhs,
   // Karatsuba uses the following trick to reduce the number of multiplications
   // from 4 to 3.
 
+  // The three sub-products are independent: compute them in parallel if
+  // they are big enough to pay for a task.
+  if (lh - ll + 1 < KARATSUBA_PARALLEL_WORDS)
+    pool = nullptr;
+
   // Z0 = ac
-  auto z0 = karatsuba_multiply_recurse(lhs, rhs, lm + 1, lh, rm + 1, rh);
   // Z2 = bd
-  auto z2 = karatsuba_multiply_recurse(lhs, rhs, ll, lm, rl, rm);
-
   // Z1 = bc + ad = (a + b) (c + d) - Z0 - Z2
-  auto a_plus_b = add(lhs, lhs, lm + 1, lh, ll, lm);
-  auto c_plus_d = add(rhs, rhs, rm + 1, rh, rl, rm);
-
-  // Note: a_plus_b and c_plus_d may not have sizes that are exact
-  // powers of 2. Directly calling karatsuba_multiply_recurse() may
-  // not work.
-  auto a_plus_b_X_c_plus_d = karatsuba_multiply(a_plus_b, c_plus_d);
+  magnitude_t z0, z2, a_plus_b_X_c_plus_d;
+  parallel_invoke(
+      pool,
+      [&]() {
+        z0 = karatsuba_multiply_recurse(lhs, rhs, lm + 1, lh, rm + 1, rh,
+                                        pool);
+      },
+      [&]() {
+        z2 = karatsuba_multiply_recurse(lhs, rhs, ll, lm, rl, rm, pool);
+      },
+      [&]() {
+        auto a_plus_b = add(lhs, lhs, lm + 1, lh, ll, lm);
+        auto c_plus_d = add(rhs, rhs, rm + 1, rh, rl, rm);
+
+        // Note: a_plus_b and c_plus_d may not have sizes that are exact
+        // powers of 2. Directly calling karatsuba_multiply_recurse() may
+        // not work.
+        a_plus_b_X_c_plus_d = karatsuba_multiply(a_plus_b, c_plus_d, pool);
+      });
   auto z0_plus_z2 = z0 + z2;
   auto z1 = a_plus_b_X_c_plus_d - z0_plus_z2;
 
@@ -342,8 +367,9 @@ size_t power_of_two_aligned(size_t n) {
   return i;
 }
 
-// Karatsuba multiplication
-magnitude_t karatsuba_multiply(const magnitude_t &lhs, const magnitude_t &rhs) {
+// Karatsuba multiplication, in parallel if a thread pool is given.
+magnitude_t karatsuba_multiply(const magnitude_t &lhs, const magnitude_t &rhs,
+                               thread_pool *pool) {
   // Align size to power of 2. It is essential for the Karatsuba multiplication
   // algorithm that the operands in the subproblems at each recursion of the
   // divide and conquer have the same size.
@@ -355,8 +381,8 @@ magnitude_t karatsuba_multiply(const magnitude_t &lhs, const magnitude_t &rhs) {
   auto rr = rhs;
   rr << rshift;
 
-  auto res =
-      karatsuba_multiply_recurse(ll, rr, 0, ll.size() - 1, 0, rr.size() - 1);
+  auto res = karatsuba_multiply_recurse(ll, rr, 0, ll.size() - 1, 0,
+                                        rr.size() - 1, pool);
   res >> (lshift + rshift);
   return res;
 }
@@ -452,6 +478,7 @@ public:
       // Denominator greater than numerator. Return 0.
       return large_num_t();
     }
+    TRACE_ZONE("large_num_t::operator/");
 
     // First, calculate R/denominator with enough words of precision.
     // Digits of precision numerator.size() + denominator.size() + 1.
@@ -475,6 +502,7 @@ public:
     //    = 2x - (rhs * x^2)/R
     bool converged = false;
     while (!converged) {
+      TRACE_ZONE("refine");
       // y = (rhs * x^2)/R
       large_num_t y = rhs * x * x;
       y.mMagnitude >> shift;
@@ -568,5 +596,27 @@ int main() {
   std::cout << std::endl << n3 << " / " << n1 << " = " << std::endl;
   std::cout << n3 / n1 << std::endl;
 
+  // Multiply two random 1024-word numbers with and without a thread pool.
+  magn::magnitude_t big1(1024), big2(1024);
+  xoshiro256 rng;
+  for (auto &w : big1)
+    w = rng.next32();
+  for (auto &w : big2)
+    w = rng.next32();
+
+  thread_pool pool;
+  exec_time et, pet;
+  magn::magnitude_t prod, pprod;
+  et([&]() { prod = magn::karatsuba_multiply(big1, big2); });
+  pet([&]() { pprod = magn::karatsuba_multiply(big1, big2, &pool); });
+  std::cout << std::endl
+            << "Karatsuba, " << big1.size() << " words: " << et.get()
+            << " ms, with " << pool.size() << " threads: " << pet.get()
+            << " ms" << std::endl;
+  if (pprod != prod) {
+    std::cout << "FAIL: parallel product differs." << std::endl;
+    return 1;
+  }
+
   return 0;
 }
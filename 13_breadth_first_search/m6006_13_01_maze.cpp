@@ -6,13 +6,19 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
-#include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "alloc_tracker.hpp"
+#include "exec_time.hpp"
+#include "thread_pool.hpp"
+
 #define INVALID INT64_MAX
 
 // Characters denoting the significance of a maze position.
@@ -22,6 +28,9 @@
 #define OBST 'O'
 #define TRAIL '#'
 
+// Frontier positions expanded by one task of the thread pool.
+#define BFS_GRAIN 256
+
 class MazeBoard {
 private:
   typedef std::vector<char> maze_row_t;
@@ -74,70 +83,90 @@ public:
   }
 
   // BFS solve
-  void solve() {
+  // The search goes level by level: the positions of the frontier are
+  // expanded in chunks, in parallel if a thread pool is given, and the
+  // positions discovered by the chunks, in chunk order, form the next
+  // frontier. A position is claimed by atomically marking it visited.
+  // Without a pool this visits the positions in the order of a FIFO queue
+  // based BFS.
+  void solve(thread_pool *pool = nullptr) {
     if (start_i == INVALID || start_j == INVALID || end_i == INVALID ||
         end_j == INVALID || nrows == INVALID || ncols == INVALID) {
       return;
     }
 
     // Instead of tuples, separate data-structures for each dimension is easier
-    // to handle.
-    ssize_t parent_i[nrows][ncols];
-    ssize_t parent_j[nrows][ncols];
-
-    for (ssize_t i = 0; i < nrows; ++i)
-      for (ssize_t j = 0; j < ncols; ++j)
-        parent_i[i][j] = parent_j[i][j] = INVALID;
-
-    parent_i[start_i][start_j] = start_i;
-    parent_j[start_i][start_j] = start_j;
-
-    std::list<ssize_t> frontier_i;
-    std::list<ssize_t> frontier_j;
+    // to handle. Position (i, j) is at index i * ncols + j; the arrays are
+    // on the heap as big mazes would overflow the stack.
+    std::vector<ssize_t> parent_i(nrows * ncols, INVALID);
+    std::vector<ssize_t> parent_j(nrows * ncols, INVALID);
+    std::unique_ptr<std::atomic<bool>[]> visited(
+        new std::atomic<bool>[nrows * ncols]);
+    for (ssize_t p = 0; p < nrows * ncols; ++p)
+      visited[p].store(false, std::memory_order_relaxed);
+
+    const auto start = start_i * ncols + start_j;
+    parent_i[start] = start_i;
+    parent_j[start] = start_j;
+    visited[start].store(true, std::memory_order_relaxed);
 
     // Start BFS with start node.
-    frontier_i.push_back(start_i);
-    frontier_j.push_back(start_j);
+    std::vector<ssize_t> frontier_i(1, start_i);
+    std::vector<ssize_t> frontier_j(1, start_j);
 
     // Relative positions of neighbors wrt current node.
     const ssize_t move_i[] = {-1, 0, 0, 1};
     const ssize_t move_j[] = {0, -1, 1, 0};
 
-    // BFS loop.
-    while (!frontier_i.empty()) {
-      auto i = frontier_i.front();
-      auto j = frontier_j.front();
-      frontier_i.pop_front();
-      frontier_j.pop_front();
-
-      // Found end?
-      if (i == end_i && j == end_j) {
-        break;
-      }
-
-      for (auto m = 0; m < 4; ++m) {
-        auto ni = i + move_i[m];
-        auto nj = j + move_j[m];
-
-        if (ni >= 0 && ni < nrows && nj >= 0 && nj < ncols &&
-            maze[ni][nj] != OBST && parent_i[ni][nj] == INVALID) {
-          frontier_i.push_back(ni);
-          frontier_j.push_back(nj);
-          parent_i[ni][nj] = i;
-          parent_j[ni][nj] = j;
+    // BFS loop, one level per iteration, till the end is found.
+    while (!frontier_i.empty() &&
+           !visited[end_i * ncols + end_j].load(std::memory_order_relaxed)) {
+      const size_t num_chunks =
+          (frontier_i.size() + BFS_GRAIN - 1) / BFS_GRAIN;
+      std::vector<std::vector<ssize_t>> next_i(num_chunks);
+      std::vector<std::vector<ssize_t>> next_j(num_chunks);
+
+      parallel_for(pool, 0, num_chunks, 1, [&](size_t c) {
+        const size_t last = std::min(frontier_i.size(), (c + 1) * BFS_GRAIN);
+        for (size_t k = c * BFS_GRAIN; k < last; ++k) {
+          auto i = frontier_i[k];
+          auto j = frontier_j[k];
+
+          for (auto m = 0; m < 4; ++m) {
+            auto ni = i + move_i[m];
+            auto nj = j + move_j[m];
+
+            if (ni >= 0 && ni < nrows && nj >= 0 && nj < ncols &&
+                maze[ni][nj] != OBST &&
+                !visited[ni * ncols + nj].exchange(true)) {
+              next_i[c].push_back(ni);
+              next_j[c].push_back(nj);
+              parent_i[ni * ncols + nj] = i;
+              parent_j[ni * ncols + nj] = j;
+            }
+          }
         }
+      });
+
+      frontier_i.clear();
+      frontier_j.clear();
+      for (size_t c = 0; c < num_chunks; ++c) {
+        frontier_i.insert(frontier_i.end(), next_i[c].begin(),
+                          next_i[c].end());
+        frontier_j.insert(frontier_j.end(), next_j[c].begin(),
+                          next_j[c].end());
       }
     }
 
-    auto pi = parent_i[end_i][end_j];
-    auto pj = parent_j[end_i][end_j];
+    auto pi = parent_i[end_i * ncols + end_j];
+    auto pj = parent_j[end_i * ncols + end_j];
 
     // Draw the solution trail on the maze board.
     while (!(pi == start_i && pj == start_j) &&
            (pi != INVALID && pj != INVALID)) {
       maze[pi][pj] = TRAIL;
-      auto pii = parent_i[pi][pj];
-      auto pjj = parent_j[pi][pj];
+      auto pii = parent_i[pi * ncols + pj];
+      auto pjj = parent_j[pi * ncols + pj];
       pi = pii;
       pj = pjj;
     }
@@ -160,17 +189,47 @@ std::ostream &operator<<(std::ostream &os, const MazeBoard &m) {
   return os;
 }
 
+// Upper bound on num_threads, well above any core count the BFS can use.
+static const unsigned long MAX_THREADS = 256;
+
 int main(int argc, char *argv[]) {
-  if (argc != 2) {
-    std::cerr << "Usage: " << argv[0] << " maze_file" << std::endl;
+  // num_threads must be a number in [1, MAX_THREADS]. strtoul would also
+  // take a sign, so the first character must be a digit.
+  unsigned long num_threads = 0;
+  bool args_ok = (argc == 2 || argc == 3);
+  if (argc == 3) {
+    char *end = nullptr;
+    if (argv[2][0] >= '0' && argv[2][0] <= '9')
+      num_threads = std::strtoul(argv[2], &end, 10);
+    args_ok = end && *end == '\0' && num_threads > 0 &&
+              num_threads <= MAX_THREADS;
+  }
+  if (!args_ok) {
+    std::cerr << "Usage: " << argv[0] << " maze_file [num_threads]"
+              << std::endl;
+    std::cerr << "       num_threads: 1 to " << MAX_THREADS << std::endl;
     return 1;
   }
 
   MazeBoard m;
   m.load(argv[1]);
-  m.solve();
+
+  // Expand the BFS frontiers on a thread pool, if asked to.
+  std::unique_ptr<thread_pool> pool;
+  if (num_threads > 0)
+    pool.reset(new thread_pool(num_threads));
+
+  // Measure the time and heap traffic of the BFS.
+  exec_time et;
+  alloc_tracker::stats_t as;
+  {
+    alloc_tracker::scope s;
+    et([&m, &pool]() { m.solve(pool.get()); });
+    as = s.get();
+  }
 
   std::cout << m << std::endl;
+  std::cout << "Solve time: " << et.get() << " ms. " << as << std::endl;
 
   return 0;
 }
@@ -6,11 +6,22 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include <cstdint>
 #include <iostream>
 #include <list>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "bench_baseline.hpp"
+#include "benchmark.hpp"
+#include "event_counters.hpp"
 #include "indexed_priority_queue.hpp"
+#include "pairing_heap.hpp"
+#include "radix_heap.hpp"
+#include "rng.hpp"
 
 // Weighted graph using adjacency lists.
 class Graph {
@@ -28,6 +39,13 @@ public:
     }
   };
 
+  // Priority of a vertex_cost_t for the radix heap: the non-negative cost.
+  struct vertex_cost_priority {
+    uint64_t operator()(const vertex_cost_t &vc) const {
+      return static_cast<uint64_t>(vc.second);
+    }
+  };
+
   // Hash functor for vertex_cost_t. Only the vertex_t (first) component is
   // used as a key.
   struct vertex_cost_key_hash {
@@ -55,6 +73,26 @@ public:
 
   enum directionality_t { DIRECTED, UNDIRECTED };
 
+  // The priority queues sssp_dijkstra can be instantiated with.
+  typedef indexed_priority_queue<vertex_cost_t, vertex_cost_cmp,
+                                 vertex_cost_key_hash, vertex_cost_key_equal>
+      ipq_t;
+  typedef pairing_heap<vertex_cost_t, vertex_cost_cmp, vertex_cost_key_hash,
+                       vertex_cost_key_equal>
+      pairing_heap_t;
+  typedef radix_heap<vertex_cost_t, vertex_cost_priority, vertex_cost_key_hash,
+                     vertex_cost_key_equal>
+      radix_heap_t;
+
+  // Shortest paths from a source.
+  struct sssp_t {
+    // Map of a vertex to its previous vertex in the shortest path from src.
+    std::unordered_map<vertex_t, vertex_t> parents;
+
+    // Map of a vertex to the cost of the shortest path from src.
+    std::unordered_map<vertex_t, int> costs;
+  };
+
 private:
   // Whether edges are directed or undirected.
   const directionality_t mDir;
@@ -62,73 +100,119 @@ private:
   // The adjacency list.
   adj_list_t mAdjList;
 
+  // Vertices get dense ids in the order they are added. The edges are kept
+  // by id too, so that the searches keep the state of a vertex (e.g. its
+  // queue handle) in a vector slot instead of hashing it at every edge.
+  std::unordered_map<vertex_t, size_t> mIds;
+  std::vector<vertex_t> mNames;
+  std::vector<std::vector<std::pair<size_t, int>>> mEdges;
+
   enum { INFINITE = 0x7FFFFFFF };
 
+  // Id of no vertex, e.g. the parent of the source.
+  static constexpr size_t NONE = static_cast<size_t>(-1);
+
+  // Id of a vertex, which is added if new.
+  size_t intern(const vertex_t &vertex) {
+    const auto res = mIds.emplace(vertex, mNames.size());
+    if (res.second) {
+      mNames.push_back(vertex);
+      mEdges.emplace_back();
+    }
+    return res.first->second;
+  }
+
 public:
   Graph(directionality_t d) : mDir(d) {}
 
   // Adds a single vertex to the graph. Useful to specify 0-degree vertices.
   void add_vertex(const vertex_t &vertex) {
+    intern(vertex);
     if (mAdjList.find(vertex) == mAdjList.end())
       mAdjList[vertex] = neighbors_t();
   }
 
-  // Adds an edge to the graph.
+  // Adds an edge to the graph. As in the adjacency sets, only the first
+  // edge between two vertices counts.
   void add_edge(const vertex_t &src, const vertex_t &dst, int cost) {
-    mAdjList[src].insert(std::make_pair(dst, cost));
-    if (mDir == UNDIRECTED)
-      mAdjList[dst].insert(make_pair(src, cost));
+    const size_t s = intern(src), d = intern(dst);
+    if (mAdjList[src].insert(std::make_pair(dst, cost)).second)
+      mEdges[s].push_back(std::make_pair(d, cost));
+    if (mDir == UNDIRECTED && mAdjList[dst].insert(make_pair(src, cost)).second)
+      mEdges[d].push_back(std::make_pair(s, cost));
   }
 
   // Calculate Single-Source Shortest Paths using Dijkstra's algorith.
-  void sssp_dijkstra(const vertex_t &src) const {
+  // PQ is the priority queue: ipq_t, pairing_heap_t, radix_heap_t or any
+  // queue with the same handle based interface.
+  template <class PQ = ipq_t> sssp_t sssp_dijkstra(const vertex_t &src) const {
+    sssp_t res;
+    auto &parents = res.parents;
+    parents[src] = vertex_t();
 
-    // Map of a vertex to its previous vertex in the shortest path from src.
-    std::unordered_map<vertex_t, vertex_t> parents;
+    auto sitr = mIds.find(src);
+    if (sitr == mIds.end()) {
+      // A vertex without edges.
+      res.costs[src] = 0;
+      return res;
+    }
 
     // Indexed priority queue tracking the node with the best cost.
-    indexed_priority_queue<vertex_cost_t, vertex_cost_cmp, vertex_cost_key_hash,
-                           vertex_cost_key_equal>
-        ipq;
+    PQ ipq;
+
+    // Handles of the vertices queued so far, by id. A vertex whose handle
+    // is no longer contained in the ipq has already been relaxed.
+    std::vector<typename PQ::handle_t> handles(mNames.size());
+    std::vector<bool> queued(mNames.size(), false);
 
-    // The vertices that have already been relaxed.
-    std::unordered_set<vertex_t> relaxed;
+    // Previous vertex in the shortest path from src, by id.
+    std::vector<size_t> parent(mNames.size(), NONE);
 
     // Start with the src in the queue with cost 0.
-    ipq.push(std::make_pair(src, 0));
-    parents[src] = vertex_t();
+    handles[sitr->second] = ipq.push(std::make_pair(src, 0));
+    queued[sitr->second] = true;
 
     while (!ipq.empty()) {
       // Get the vertex with least cost.
       const auto cur_vc = ipq.top();
       ipq.pop();
-      relaxed.insert(cur_vc.first);
-
-      auto adjItr = mAdjList.find(cur_vc.first);
-      if (adjItr != mAdjList.end()) {
-        // Iterate over all the edges emanating out of the current vertex.
-        for (const auto &edge : adjItr->second) {
-          if (relaxed.find(edge.first) == relaxed.end()) {
-            // Find the destination of the edge in the ipq.
-            // Make find return INFINITE cost if not present.
-            const auto invc = std::make_pair(edge.first, INFINITE);
-            const auto vc = ipq.find(invc, invc);
-            // Relax.
-            if (cur_vc.second + edge.second < vc.second) {
-              // If the vertex is already present in the ipq, push will update
-              // its cost and reposition it in the priority queue based on the
-              // updated cost.
-              ipq.push(std::make_pair(edge.first, cur_vc.second + edge.second));
-              parents[edge.first] = cur_vc.first;
-            }
-          }
+      res.costs[cur_vc.first] = cur_vc.second;
+      const size_t u = mIds.find(cur_vc.first)->second;
+
+      // Iterate over all the edges emanating out of the current vertex.
+      for (const auto &edge : mEdges[u]) {
+        const size_t v = edge.first;
+        const auto cost = cur_vc.second + edge.second;
+        if (!queued[v]) {
+          // First time reached: INFINITE cost so far.
+          COUNT_EVENT("dijkstra.relaxations");
+          handles[v] = ipq.push(std::make_pair(mNames[v], cost));
+          queued[v] = true;
+          parent[v] = u;
+        } else if (ipq.contains(handles[v]) &&
+                   cost < ipq.priority(handles[v]).second) {
+          // Relax. The handle repositions the vertex in the priority queue
+          // based on the updated cost, which is written in place: the
+          // vertex is neither copied nor looked up again.
+          COUNT_EVENT("dijkstra.relaxations");
+          ipq.decrease_key(handles[v], cost);
+          parent[v] = u;
         }
       }
     }
 
-    // Construct and print the shortest paths by following the parent links.
-    std::cout << "Shortest paths from: " << src << std::endl;
-    for (const auto &p : parents) {
+    for (size_t v = 0; v < mNames.size(); ++v)
+      if (parent[v] != NONE)
+        parents[mNames[v]] = mNames[parent[v]];
+
+    return res;
+  }
+
+  // Construct and print the shortest paths by following the parent links.
+  static void print_paths(std::ostream &os, const vertex_t &src,
+                          const sssp_t &sp) {
+    os << "Shortest paths from: " << src << std::endl;
+    for (const auto &p : sp.parents) {
       if (p.first == src)
         continue;
 
@@ -136,13 +220,13 @@ public:
       auto v = p.first;
       while (v != src) {
         path.push_front(v);
-        v = parents[v];
+        v = sp.parents.at(v);
       }
       path.push_front(src);
 
-      for (const auto vp : path)
-        std::cout << vp << " ";
-      std::cout << std::endl;
+      for (const auto &vp : path)
+        os << vp << " ";
+      os << std::endl;
     }
   }
 
@@ -174,7 +258,53 @@ int main() {
   std::cout << "Graph: " << std::endl << g << std::endl;
 
   // Dijkstra's.
-  g.sssp_dijkstra("G");
+  Graph::print_paths(std::cout, "G", g.sssp_dijkstra("G"));
+  std::cout << std::endl;
+
+  // Dijkstra's with a pairing heap.
+  Graph::print_paths(std::cout, "G",
+                     g.sssp_dijkstra<Graph::pairing_heap_t>("G"));
+  std::cout << std::endl;
+
+  // Dijkstra's with a radix heap.
+  Graph::print_paths(std::cout, "G", g.sssp_dijkstra<Graph::radix_heap_t>("G"));
+  std::cout << std::endl;
+
+  // Head to head on a large sparse random graph.
+  const size_t V = 20000;
+  const size_t E = 4 * V;
+  Graph lg(Graph::UNDIRECTED);
+  xoshiro256 rng;
+  for (size_t i = 0; i < E; ++i)
+    lg.add_edge(std::to_string(rng.bounded(V)), std::to_string(rng.bounded(V)),
+                rng.uniform(1, 1000));
+
+  const auto expected = lg.sssp_dijkstra("0").costs;
+  if (lg.sssp_dijkstra<Graph::pairing_heap_t>("0").costs != expected) {
+    std::cout << "Mismatch between binary heap and pairing heap." << std::endl;
+    return 1;
+  }
+  if (lg.sssp_dijkstra<Graph::radix_heap_t>("0").costs != expected) {
+    std::cout << "Mismatch between binary heap and radix heap." << std::endl;
+    return 1;
+  }
 
-  return 0;
+  std::cout << "Dijkstra on a random graph, V = " << V << ", E = " << E
+            << std::endl;
+  benchmark bm(benchmark::config_t(1, 5));
+  bench_baseline bl;
+  bl.add(bm.run("sssp_dijkstra<ipq_t>",
+                [&lg]() { return lg.sssp_dijkstra<Graph::ipq_t>("0"); }),
+         V);
+  bl.add(bm.run("sssp_dijkstra<pairing_heap_t>",
+                [&lg]() {
+                  return lg.sssp_dijkstra<Graph::pairing_heap_t>("0");
+                }),
+         V);
+  bl.add(bm.run("sssp_dijkstra<radix_heap_t>",
+                [&lg]() { return lg.sssp_dijkstra<Graph::radix_heap_t>("0"); }),
+         V);
+  bm.print(std::cout);
+
+  return bl.finish_from_env(std::cout) ? 1 : 0;
 }
@@ -0,0 +1,161 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "bench_baseline.hpp"
+#include "dense_indexed_priority_queue.hpp"
+#include "indexed_priority_queue.hpp"
+#include "int_graph.hpp"
+#include "rng.hpp"
+
+typedef int_graph::vertex_t vertex_t;
+typedef int_graph::vertex_cost_t vertex_cost_t;
+
+// Parent of unreachable vertices and of the source.
+static constexpr vertex_t NONE = static_cast<vertex_t>(-1);
+
+// Shortest path costs and parents of all the vertices from a source.
+struct sssp_t {
+  std::vector<int> cost;
+  std::vector<vertex_t> parent;
+
+  explicit sssp_t(size_t num_vertices)
+      : cost(num_vertices, int_graph::INFINITE), parent(num_vertices, NONE) {}
+};
+
+// Dijkstra's algorithm using the hash indexed priority queue. Every find
+// and every update of a vertex in the queue hashes the vertex.
+sssp_t sssp_dijkstra_hashed(const int_graph &g, vertex_t src) {
+  sssp_t res(g.num_vertices());
+
+  indexed_priority_queue<vertex_cost_t, int_graph::vertex_cost_cmp,
+                         int_graph::vertex_cost_key_hash,
+                         int_graph::vertex_cost_key_equal>
+      ipq;
+  std::vector<bool> relaxed(g.num_vertices(), false);
+
+  ipq.push(std::make_pair(src, 0));
+
+  while (!ipq.empty()) {
+    // Get the vertex with least cost.
+    const auto cur_vc = ipq.top();
+    ipq.pop();
+    relaxed[cur_vc.first] = true;
+    res.cost[cur_vc.first] = cur_vc.second;
+
+    for (const auto &edge : g.neighbors(cur_vc.first)) {
+      if (relaxed[edge.first])
+        continue;
+      // Make find return INFINITE cost if not present.
+      const auto invc = std::make_pair(edge.first, int(int_graph::INFINITE));
+      const auto vc = ipq.find(invc, invc);
+      // Relax.
+      if (cur_vc.second + edge.second < vc.second) {
+        ipq.push(std::make_pair(edge.first, cur_vc.second + edge.second));
+        res.parent[edge.first] = cur_vc.first;
+      }
+    }
+  }
+
+  return res;
+}
+
+// Dijkstra's algorithm using the dense indexed priority queue. The
+// vertices are the ids of the queue, so a decrease-key is a couple of array
+// accesses and never hashes.
+sssp_t sssp_dijkstra_dense(const int_graph &g, vertex_t src) {
+  sssp_t res(g.num_vertices());
+
+  dense_indexed_priority_queue<int> ipq(g.num_vertices());
+  std::vector<bool> relaxed(g.num_vertices(), false);
+
+  ipq.push(src, 0);
+
+  while (!ipq.empty()) {
+    // Get the vertex with least cost.
+    const auto u = ipq.top();
+    const auto cost = ipq.top_priority();
+    ipq.pop();
+    relaxed[u] = true;
+    res.cost[u] = cost;
+
+    for (const auto &edge : g.neighbors(u)) {
+      if (relaxed[edge.first])
+        continue;
+      // Relax.
+      if (cost + edge.second < ipq.find(edge.first, int_graph::INFINITE)) {
+        ipq.push(edge.first, cost + edge.second);
+        res.parent[edge.first] = u;
+      }
+    }
+  }
+
+  return res;
+}
+
+// Construct and print the shortest paths by following the parent links.
+void print_paths(std::ostream &os, vertex_t src, const sssp_t &sp) {
+  os << "Shortest paths from: " << src << std::endl;
+  for (vertex_t v = 0; v < sp.parent.size(); ++v) {
+    if (v == src || sp.parent[v] == NONE)
+      continue;
+
+    std::list<vertex_t> path;
+    for (auto p = v; p != src; p = sp.parent[p])
+      path.push_front(p);
+    path.push_front(src);
+
+    for (const auto &vp : path)
+      os << vp << " ";
+    os << "(" << sp.cost[v] << ")" << std::endl;
+  }
+}
+
+int main() {
+  // The graph of m006_16_01_dijkstra with G, Y, P, R, B as 0 .. 4.
+  int_graph g(5);
+  g.add_edge(0, 1, 19);
+  g.add_edge(0, 2, 7);
+  g.add_edge(2, 1, 11);
+  g.add_edge(1, 3, 4);
+  g.add_edge(2, 3, 15);
+  g.add_edge(2, 4, 5);
+  g.add_edge(3, 4, 13);
+
+  std::cout << "Hash indexed:" << std::endl;
+  print_paths(std::cout, 0, sssp_dijkstra_hashed(g, 0));
+  std::cout << "Dense indexed:" << std::endl;
+  print_paths(std::cout, 0, sssp_dijkstra_dense(g, 0));
+  std::cout << std::endl;
+
+  // A large sparse random graph.
+  const size_t V = 50000;
+  const size_t E = 4 * V;
+  xoshiro256 rng;
+  const int_graph lg(V, E, rng);
+
+  if (sssp_dijkstra_hashed(lg, 0).cost != sssp_dijkstra_dense(lg, 0).cost) {
+    std::cout << "Mismatch between hash and dense indexed Dijkstra."
+              << std::endl;
+    return 1;
+  }
+
+  std::cout << "Dijkstra on a random graph, V = " << V << ", E = " << E
+            << std::endl;
+  baseline_benchmark bb;
+  bb.run("sssp_dijkstra_hashed", V,
+         [&lg]() { return sssp_dijkstra_hashed(lg, 0); });
+  bb.run("sssp_dijkstra_dense", V,
+         [&lg]() { return sssp_dijkstra_dense(lg, 0); });
+
+  return bb.finish(std::cout) ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench_baseline.hpp"
+#include "indexed_priority_queue.hpp"
+#include "int_graph.hpp"
+#include "rng.hpp"
+
+// Sweep of the FANOUT of indexed_priority_queue on Dijkstra's algorithm.
+// A sparse graph stresses pop (sift down compares FANOUT children per
+// level), a denser one stresses decrease-key (sift up, which gets shorter
+// as the heap gets flatter).
+
+// Costs of the shortest paths from src with a heap of the given FANOUT.
+// The handles are kept per vertex so that relaxations do not hash.
+template <size_t FANOUT>
+std::vector<int> sssp_dijkstra(const int_graph &g, int_graph::vertex_t src) {
+  typedef indexed_priority_queue<
+      int_graph::vertex_cost_t, int_graph::vertex_cost_cmp,
+      int_graph::vertex_cost_key_hash, int_graph::vertex_cost_key_equal, FANOUT>
+      ipq_t;
+  const auto NO_HANDLE = ipq_t::NOT_QUEUED;
+
+  std::vector<int> cost(g.num_vertices(), int_graph::INFINITE);
+  std::vector<typename ipq_t::handle_t> handles(g.num_vertices(), NO_HANDLE);
+  ipq_t ipq;
+
+  handles[src] = ipq.push(std::make_pair(src, 0));
+
+  while (!ipq.empty()) {
+    const auto cur_vc = ipq.top();
+    ipq.pop();
+    cost[cur_vc.first] = cur_vc.second;
+
+    for (const auto &edge : g.neighbors(cur_vc.first)) {
+      const auto c = cur_vc.second + edge.second;
+      const auto h = handles[edge.first];
+      if (h == NO_HANDLE)
+        handles[edge.first] = ipq.push(std::make_pair(edge.first, c));
+      else if (ipq.contains(h) && c < ipq.priority(h).second)
+        ipq.decrease_key(h, std::make_pair(edge.first, c));
+    }
+  }
+
+  return cost;
+}
+
+// Benchmark all fanouts on one graph. Returns false if they disagree.
+static bool sweep(const std::string &name, const int_graph &g,
+                  baseline_benchmark &bb) {
+  const auto expected = sssp_dijkstra<2>(g, 0);
+  if (sssp_dijkstra<4>(g, 0) != expected ||
+      sssp_dijkstra<8>(g, 0) != expected ||
+      sssp_dijkstra<16>(g, 0) != expected) {
+    std::cout << name << ": results differ between fanouts." << std::endl;
+    return false;
+  }
+
+  const auto n = g.num_vertices();
+  bb.run(name + " FANOUT 2", n, [&g]() { return sssp_dijkstra<2>(g, 0); });
+  bb.run(name + " FANOUT 4", n, [&g]() { return sssp_dijkstra<4>(g, 0); });
+  bb.run(name + " FANOUT 8", n, [&g]() { return sssp_dijkstra<8>(g, 0); });
+  bb.run(name + " FANOUT 16", n, [&g]() { return sssp_dijkstra<16>(g, 0); });
+  return true;
+}
+
+int main() {
+  xoshiro256 rng;
+
+  // Average degree 8: pop dominated.
+  const int_graph sparse(50000, 200000, rng);
+
+  // Average degree 128: decrease-key dominated.
+  const int_graph dense(4000, 256000, rng);
+
+  baseline_benchmark bb;
+  if (!sweep("sparse", sparse, bb) || !sweep("dense", dense, bb))
+    return 1;
+
+  return bb.finish(std::cout) ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "bench_baseline.hpp"
+#include "indexed_priority_queue.hpp"
+#include "int_graph.hpp"
+#include "rng.hpp"
+
+// Multi-source Dijkstra (the cost from every vertex to its nearest
+// facility) with single and with batched operations of
+// indexed_priority_queue. The batched version seeds the queue with all the
+// facilities through the O(n) bulk build and relaxes all the edges of
+// a vertex with one update_batch and one push_batch, which pays off at the
+// hubs of the graph.
+
+typedef int_graph::vertex_t vertex_t;
+typedef int_graph::vertex_cost_t vertex_cost_t;
+
+typedef indexed_priority_queue<vertex_cost_t, int_graph::vertex_cost_cmp,
+                               int_graph::vertex_cost_key_hash,
+                               int_graph::vertex_cost_key_equal>
+    ipq_t;
+
+static constexpr ipq_t::handle_t NO_HANDLE = ipq_t::NOT_QUEUED;
+
+// Cost from every vertex to the nearest facility, one queue operation at a
+// time.
+std::vector<int> nearest_facility(const int_graph &g,
+                                  const std::vector<vertex_t> &facilities) {
+  std::vector<int> cost(g.num_vertices(), int_graph::INFINITE);
+  std::vector<ipq_t::handle_t> handles(g.num_vertices(), NO_HANDLE);
+  ipq_t ipq;
+
+  for (const auto f : facilities) {
+    handles[f] = ipq.push(std::make_pair(f, 0));
+    cost[f] = 0;
+  }
+
+  while (!ipq.empty()) {
+    const auto cur_vc = ipq.top();
+    ipq.pop();
+
+    for (const auto &edge : g.neighbors(cur_vc.first)) {
+      const auto c = cur_vc.second + edge.second;
+      const auto h = handles[edge.first];
+      if ((h != NO_HANDLE && !ipq.contains(h)) || c >= cost[edge.first])
+        continue;
+      cost[edge.first] = c;
+      if (h == NO_HANDLE)
+        handles[edge.first] = ipq.push(std::make_pair(edge.first, c));
+      else
+        ipq.decrease_key(h, std::make_pair(edge.first, c));
+    }
+  }
+
+  return cost;
+}
+
+// Same as nearest_facility, with bulk construction and batched updates.
+std::vector<int>
+nearest_facility_batched(const int_graph &g,
+                         const std::vector<vertex_t> &facilities) {
+  std::vector<int> cost(g.num_vertices(), int_graph::INFINITE);
+  std::vector<ipq_t::handle_t> handles(g.num_vertices(), NO_HANDLE);
+
+  std::vector<vertex_cost_t> seeds;
+  for (const auto f : facilities)
+    seeds.push_back(std::make_pair(f, 0));
+  ipq_t ipq;
+  const auto seeded = ipq.build(seeds.begin(), seeds.end());
+  for (size_t i = 0; i < facilities.size(); ++i) {
+    handles[facilities[i]] = seeded[i];
+    cost[facilities[i]] = 0;
+  }
+
+  // Relaxations of the edges of the current vertex.
+  std::vector<std::pair<ipq_t::handle_t, vertex_cost_t>> updates;
+  std::vector<vertex_cost_t> pushes;
+
+  while (!ipq.empty()) {
+    const auto cur_vc = ipq.top();
+    ipq.pop();
+
+    updates.clear();
+    pushes.clear();
+    for (const auto &edge : g.neighbors(cur_vc.first)) {
+      const auto c = cur_vc.second + edge.second;
+      const auto h = handles[edge.first];
+      if ((h != NO_HANDLE && !ipq.contains(h)) || c >= cost[edge.first])
+        continue;
+      // Later relaxations of the same vertex are cheaper and win.
+      cost[edge.first] = c;
+      if (h == NO_HANDLE)
+        pushes.push_back(std::make_pair(edge.first, c));
+      else
+        updates.push_back(std::make_pair(h, std::make_pair(edge.first, c)));
+    }
+
+    ipq.update_batch(updates.begin(), updates.end());
+    const auto pushed = ipq.push_batch(pushes.begin(), pushes.end());
+    for (size_t i = 0; i < pushes.size(); ++i)
+      handles[pushes[i].first] = pushed[i];
+  }
+
+  return cost;
+}
+
+int main() {
+  const size_t V = 50000;
+  xoshiro256 rng;
+
+  // A sparse random graph, average degree 6 ...
+  int_graph g(V, 3 * V, rng);
+
+  // ... with hubs of degree 2000.
+  for (size_t hub = 0; hub < 50; ++hub)
+    for (size_t i = 0; i < 2000; ++i)
+      g.add_edge(hub, rng.bounded(V), rng.uniform(1, 1000));
+
+  std::vector<vertex_t> facilities(1000);
+  for (auto &f : facilities)
+    f = rng.bounded(V);
+
+  const auto cost = nearest_facility(g, facilities);
+  if (nearest_facility_batched(g, facilities) != cost) {
+    std::cout << "Mismatch between single and batched operations."
+              << std::endl;
+    return 1;
+  }
+  int farthest = 0;
+  for (const auto c : cost)
+    if (c != int_graph::INFINITE)
+      farthest = std::max(farthest, c);
+  std::cout << "Farthest reachable vertex from a facility: " << farthest
+            << std::endl;
+
+  std::cout << "Multi-source Dijkstra, V = " << V << ", "
+            << facilities.size() << " facilities" << std::endl;
+  baseline_benchmark bb;
+  bb.run("nearest_facility", V,
+         [&]() { return nearest_facility(g, facilities); });
+  bb.run("nearest_facility_batched", V,
+         [&]() { return nearest_facility_batched(g, facilities); });
+
+  return bb.finish(std::cout) ? 1 : 0;
+}
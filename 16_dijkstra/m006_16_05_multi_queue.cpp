@@ -0,0 +1,221 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench_baseline.hpp"
+#include "indexed_priority_queue.hpp"
+#include "int_graph.hpp"
+#include "multi_queue.hpp"
+#include "rng.hpp"
+
+// Throughput of multi_queue from 1 to N threads, and a parallel
+// (label-correcting) Dijkstra on top of it. The wasted pops of stale
+// elements show the price of the relaxation for a number of heaps per
+// thread.
+
+typedef int_graph::vertex_t vertex_t;
+typedef int_graph::vertex_cost_t vertex_cost_t;
+
+// The cost of a vertex_cost_t as a multi_queue priority.
+struct vertex_cost_key {
+  uint64_t operator()(const vertex_cost_t &vc) const { return vc.second; }
+};
+
+typedef indexed_priority_queue<vertex_cost_t, int_graph::vertex_cost_cmp,
+                               int_graph::vertex_cost_key_hash,
+                               int_graph::vertex_cost_key_equal>
+    ipq_t;
+
+typedef multi_queue<vertex_cost_t, vertex_cost_key,
+                    int_graph::vertex_cost_key_hash,
+                    int_graph::vertex_cost_key_equal>
+    mq_t;
+
+// Costs of the shortest paths from src, sequentially.
+std::vector<int> sssp_dijkstra(const int_graph &g, vertex_t src) {
+  const auto NO_HANDLE = ipq_t::NOT_QUEUED;
+  std::vector<int> cost(g.num_vertices(), int_graph::INFINITE);
+  std::vector<ipq_t::handle_t> handles(g.num_vertices(), NO_HANDLE);
+  ipq_t ipq;
+
+  handles[src] = ipq.push(std::make_pair(src, 0));
+
+  while (!ipq.empty()) {
+    const auto cur_vc = ipq.top();
+    ipq.pop();
+    cost[cur_vc.first] = cur_vc.second;
+
+    for (const auto &edge : g.neighbors(cur_vc.first)) {
+      const auto c = cur_vc.second + edge.second;
+      const auto h = handles[edge.first];
+      if (h == NO_HANDLE)
+        handles[edge.first] = ipq.push(std::make_pair(edge.first, c));
+      else if (ipq.contains(h) && c < ipq.priority(h).second)
+        ipq.decrease_key(h, std::make_pair(edge.first, c));
+    }
+  }
+
+  return cost;
+}
+
+// Costs of the shortest paths from src with num_threads threads sharing a
+// multi_queue. A vertex may be popped before its cost is final and then
+// again later; popped elements costlier than the best known cost of their
+// vertex are stale and skipped. Adds the number of pops and of stale pops
+// to the counters, if given.
+std::vector<int> sssp_parallel(const int_graph &g, vertex_t src,
+                               size_t num_threads, size_t queues_per_thread,
+                               size_t *pops = nullptr,
+                               size_t *stale = nullptr) {
+  std::vector<std::atomic<int>> cost(g.num_vertices());
+  for (auto &c : cost)
+    c.store(int_graph::INFINITE, std::memory_order_relaxed);
+
+  mq_t mq(num_threads, queues_per_thread);
+  // Elements pushed and not yet fully processed; the search is over when
+  // it drops to 0.
+  std::atomic<size_t> pending(1);
+  std::atomic<size_t> num_pops(0), num_stale(0);
+
+  cost[src].store(0, std::memory_order_relaxed);
+  mq.push(std::make_pair(src, 0));
+
+  auto worker = [&]() {
+    size_t my_pops = 0, my_stale = 0;
+    vertex_cost_t cur_vc;
+    while (pending.load(std::memory_order_acquire) != 0) {
+      if (!mq.try_pop(cur_vc)) {
+        std::this_thread::yield();
+        continue;
+      }
+      ++my_pops;
+      const auto &cur_cost = cost[cur_vc.first];
+      if (cur_vc.second > cur_cost.load(std::memory_order_relaxed)) {
+        ++my_stale;
+      } else {
+        for (const auto &edge : g.neighbors(cur_vc.first)) {
+          const int c = cur_vc.second + edge.second;
+          auto &best = cost[edge.first];
+          int old = best.load(std::memory_order_relaxed);
+          while (c < old && !best.compare_exchange_weak(old, c))
+            ;
+          // Count the element before it can be popped; uncount it if it
+          // merged with a queued one.
+          if (c < old) {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            if (!mq.push(std::make_pair(edge.first, c)))
+              pending.fetch_sub(1, std::memory_order_relaxed);
+          }
+        }
+      }
+      pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    num_pops += my_pops;
+    num_stale += my_stale;
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &t : threads)
+    t.join();
+
+  if (pops)
+    *pops += num_pops;
+  if (stale)
+    *stale += num_stale;
+
+  std::vector<int> result(g.num_vertices());
+  for (size_t v = 0; v < g.num_vertices(); ++v)
+    result[v] = cost[v].load(std::memory_order_relaxed);
+  return result;
+}
+
+// Plain integers are their own priority.
+struct u64_key {
+  uint64_t operator()(uint64_t x) const { return x; }
+};
+
+typedef multi_queue<uint64_t, u64_key> u64_mq_t;
+
+// Every thread pops an element and pushes one with a slightly higher
+// priority, ops_per_thread times, keeping the queue size steady.
+static void churn(u64_mq_t &mq, size_t num_threads, size_t ops_per_thread) {
+  auto worker = [&mq, ops_per_thread](size_t id) {
+    xoshiro256 rng(id + 1);
+    uint64_t x;
+    for (size_t i = 0; i < ops_per_thread; ++i) {
+      if (!mq.try_pop(x))
+        x = 0;
+      mq.push(x + rng.uniform(1, 1024));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t)
+    threads.emplace_back(worker, t);
+  worker(0);
+  for (auto &t : threads)
+    t.join();
+}
+
+int main() {
+  const size_t max_threads =
+      std::max<unsigned>(std::thread::hardware_concurrency(), 4);
+  std::vector<size_t> thread_counts;
+  for (size_t t = 1; t <= max_threads; t *= 2)
+    thread_counts.push_back(t);
+
+  baseline_benchmark bb;
+
+  // Push/pop throughput. The queue starts with 2^16 random elements.
+  const size_t ops_per_thread = 100000;
+  for (const auto t : thread_counts) {
+    u64_mq_t mq(t);
+    xoshiro256 rng;
+    for (size_t i = 0; i < (1 << 16); ++i)
+      mq.push(rng.next() >> 16);
+    bb.run("multi_queue churn, " + std::to_string(t) + " threads",
+           t * ops_per_thread, [&]() { churn(mq, t, ops_per_thread); });
+  }
+
+  // Parallel Dijkstra, average degree 8.
+  xoshiro256 rng;
+  const int_graph g(50000, 200000, rng);
+  const auto expected = sssp_dijkstra(g, 0);
+  for (const size_t qpt : {1, 2, 4}) {
+    for (const auto t : thread_counts) {
+      size_t pops = 0, stale = 0;
+      if (sssp_parallel(g, 0, t, qpt, &pops, &stale) != expected) {
+        std::cout << "Parallel Dijkstra with " << t
+                  << " threads gave different costs." << std::endl;
+        return 1;
+      }
+      std::cout << "threads " << t << ", heaps per thread " << qpt
+                << ": pops " << pops << ", stale " << stale << " ("
+                << 100 * stale / pops << "%)" << std::endl;
+    }
+  }
+
+  bb.run("sssp_dijkstra", g.num_vertices(),
+         [&g]() { return sssp_dijkstra(g, 0); });
+  for (const auto t : thread_counts)
+    bb.run("sssp_parallel, " + std::to_string(t) + " threads",
+           g.num_vertices(), [&g, t]() { return sssp_parallel(g, 0, t, 2); });
+
+  return bb.finish(std::cout) ? 1 : 0;
+}
@@ -11,6 +11,8 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "event_counters.hpp"
+
 // Weighted graph using adjacency lists.
 class Graph {
 
@@ -96,6 +98,7 @@ public:
             // Relax.
             if (ditr_cost == sp_costs.end() ||
                 ditr_cost->second > sitr_cost->second + nbr.second) {
+              COUNT_EVENT("bellman_ford.relaxations");
               sp_costs[nbr.first] = sitr_cost->second + nbr.second;
               parents[nbr.first] = adj.first;
             }
@@ -135,7 +138,7 @@ public:
       }
       path.push_front(src);
 
-      for (const auto vp : path)
+      for (const auto &vp : path)
         std::cout << vp << " ";
       std::cout << std::endl;
     }
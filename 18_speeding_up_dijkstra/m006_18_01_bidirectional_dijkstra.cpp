@@ -6,11 +6,23 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include <cstdint>
 #include <iostream>
 #include <list>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "bench_baseline.hpp"
+#include "benchmark.hpp"
+#include "event_counters.hpp"
 #include "indexed_priority_queue.hpp"
+#include "pairing_heap.hpp"
+#include "radix_heap.hpp"
+#include "rng.hpp"
+#include "trace.hpp"
 
 // Weighted graph using adjacency lists.
 class Graph {
@@ -28,6 +40,13 @@ public:
     }
   };
 
+  // Priority of a vertex_cost_t for the radix heap: the non-negative cost.
+  struct vertex_cost_priority {
+    uint64_t operator()(const vertex_cost_t &vc) const {
+      return static_cast<uint64_t>(vc.second);
+    }
+  };
+
   // Hash functor for vertex_cost_t. Only the vertex_t (first) component is
   // used as a key.
   struct vertex_cost_key_hash {
@@ -55,6 +74,19 @@ public:
 
   enum directionality_t { DIRECTED, UNDIRECTED };
 
+  enum { INFINITE = 0x7FFFFFFF };
+
+  // The priority queues bd_dijkstra can be instantiated with.
+  typedef indexed_priority_queue<vertex_cost_t, vertex_cost_cmp,
+                                 vertex_cost_key_hash, vertex_cost_key_equal>
+      ipq_t;
+  typedef pairing_heap<vertex_cost_t, vertex_cost_cmp, vertex_cost_key_hash,
+                       vertex_cost_key_equal>
+      pairing_heap_t;
+  typedef radix_heap<vertex_cost_t, vertex_cost_priority, vertex_cost_key_hash,
+                     vertex_cost_key_equal>
+      radix_heap_t;
+
 private:
   // Whether edges are directed or undirected.
   const directionality_t mDir;
@@ -65,54 +97,110 @@ private:
   // The adjacency list of backward edges.
   adj_list_t mAdjListBack;
 
-  enum { INFINITE = 0x7FFFFFFF };
+  // Vertices get dense ids in the order they are added. The edges are kept
+  // by id too, forward and backward, so that the searches keep the state of
+  // a vertex (e.g. its queue handle) in a vector slot instead of hashing it
+  // at every edge.
+  typedef std::vector<std::vector<std::pair<size_t, int>>> id_edges_t;
+  std::unordered_map<vertex_t, size_t> mIds;
+  std::vector<vertex_t> mNames;
+  id_edges_t mEdges;
+  id_edges_t mEdgesBack;
+
+  // Id of no vertex, e.g. the parent of the source.
+  static constexpr size_t NONE = static_cast<size_t>(-1);
+
+  // Id of a vertex, which is added if new.
+  size_t intern(const vertex_t &vertex) {
+    const auto res = mIds.emplace(vertex, mNames.size());
+    if (res.second) {
+      mNames.push_back(vertex);
+      mEdges.emplace_back();
+      mEdgesBack.emplace_back();
+    }
+    return res.first->second;
+  }
 
 public:
   Graph(directionality_t d) : mDir(d) {}
 
   // Adds a single vertex to the graph. Useful to specify 0-degree vertices.
   void add_vertex(const vertex_t &vertex) {
+    intern(vertex);
     if (mAdjList.find(vertex) == mAdjList.end())
       mAdjList[vertex] = neighbors_t();
   }
 
-  // Adds an edge to the graph.
+  // Adds an edge to the graph. As in the adjacency sets, only the first
+  // edge between two vertices counts.
   void add_edge(const vertex_t &src, const vertex_t &dst, int cost) {
-    mAdjList[src].insert(std::make_pair(dst, cost));
-    if (mDir == UNDIRECTED)
-      mAdjList[dst].insert(make_pair(src, cost));
-    else
-      mAdjListBack[dst].insert(make_pair(src, cost));
+    const size_t s = intern(src), d = intern(dst);
+    if (mAdjList[src].insert(std::make_pair(dst, cost)).second)
+      mEdges[s].push_back(std::make_pair(d, cost));
+    if (mDir == UNDIRECTED) {
+      if (mAdjList[dst].insert(make_pair(src, cost)).second)
+        mEdges[d].push_back(std::make_pair(s, cost));
+    } else if (mAdjListBack[dst].insert(make_pair(src, cost)).second) {
+      mEdgesBack[d].push_back(std::make_pair(s, cost));
+    }
   }
 
   // Calculate Shortest Path using bidirectional Dijkstra's algorithm.
-  void bd_dijkstra(const vertex_t &src, const vertex_t &dst) const {
+  // Returns the cost of the path, stored in 'path', or INFINITE if there is
+  // no path. PQ is the priority queue: ipq_t, pairing_heap_t, radix_heap_t
+  // or any queue with the same handle based interface.
+  template <class PQ = ipq_t>
+  int bd_dijkstra(const vertex_t &src, const vertex_t &dst,
+                  path_t &path) const {
+    TRACE_ZONE("bd_dijkstra");
     enum { FORWARD = 0, BACKWARD = 1, NDIR = 2 };
-    // Backward adjacncy list.
-    const adj_list_t *adjList[NDIR] = {
-        &mAdjList, (mDir == UNDIRECTED) ? &mAdjList : &mAdjListBack};
 
-    // Map of a vertex to its previous vertex in the shortest path from src.
-    std::unordered_map<vertex_t, vertex_t> parents[NDIR];
+    path.clear();
+    auto sitr = mIds.find(src), ditr = mIds.find(dst);
+    if (sitr == mIds.end() || ditr == mIds.end()) {
+      // A vertex without edges only reaches itself.
+      if (src != dst)
+        return INFINITE;
+      path.push_back(src);
+      return 0;
+    }
+
+    // Edges to follow in each direction.
+    const id_edges_t *edges[NDIR] = {
+        &mEdges, (mDir == UNDIRECTED) ? &mEdges : &mEdgesBack};
+    const size_t n = mNames.size();
+
+    // Previous vertex in the shortest path from src, by id.
+    std::vector<size_t> parents[NDIR] = {std::vector<size_t>(n, NONE),
+                                         std::vector<size_t>(n, NONE)};
 
     // Indexed priority queue tracking the node with the best cost.
-    indexed_priority_queue<vertex_cost_t, vertex_cost_cmp, vertex_cost_key_hash,
-                           vertex_cost_key_equal>
-        ipq[NDIR];
+    PQ ipq[NDIR];
 
-    // The vertices that have already been relaxed.
-    std::unordered_set<vertex_t> relaxed[NDIR];
+    // Handles of the vertices queued so far, by id. A vertex whose handle
+    // is no longer contained in the ipq has already been relaxed.
+    std::vector<typename PQ::handle_t> handles[NDIR] = {
+        std::vector<typename PQ::handle_t>(n),
+        std::vector<typename PQ::handle_t>(n)};
+    std::vector<bool> queued[NDIR] = {std::vector<bool>(n, false),
+                                      std::vector<bool>(n, false)};
 
-    // Current weights of the vertices.
-    std::unordered_map<vertex_t, int> delta[NDIR];
+    // Whether vertex v has been relaxed in direction i.
+    auto is_relaxed = [&](int i, size_t v) {
+      return queued[i][v] && !ipq[i].contains(handles[i][v]);
+    };
+
+    // Current weights of the vertices, INFINITE if not reached.
+    std::vector<int> delta[NDIR] = {std::vector<int>(n, INFINITE),
+                                    std::vector<int>(n, INFINITE)};
 
     // Start with the src/dst in the queue/backward queue with cost 0.
-    ipq[FORWARD].push(std::make_pair(src, 0));
-    parents[FORWARD][src] = vertex_t();
-    delta[FORWARD][src] = 0;
-    ipq[BACKWARD].push(std::make_pair(dst, 0));
-    parents[BACKWARD][dst] = vertex_t();
-    delta[BACKWARD][dst] = 0;
+    const size_t s[NDIR] = {sitr->second, ditr->second};
+    for (auto i = 0; i < NDIR; ++i) {
+      handles[i][s[i]] = ipq[i].push(std::make_pair(mNames[s[i]], 0));
+      queued[i][s[i]] = true;
+      delta[i][s[i]] = 0;
+    }
 
     bool done = false;
 
@@ -123,39 +211,39 @@ public:
         if (ipq[i].empty())
           continue;
         ++active_ipqs;
+        TRACE_ZONE(i == FORWARD ? "forward" : "backward");
 
         // Get the vertex with least cost.
         const auto cur_vc = ipq[i].top();
         ipq[i].pop();
-        relaxed[i].insert(cur_vc.first);
+        const size_t u = mIds.find(cur_vc.first)->second;
         // Have the frontiers just collided?
-        if (relaxed[NDIR - 1 - i].find(cur_vc.first) !=
-            relaxed[NDIR - 1 - i].end()) {
+        if (is_relaxed(NDIR - 1 - i, u)) {
           done = true;
           break;
         }
 
-        auto adjItr = adjList[i]->find(cur_vc.first);
-        if (adjItr != adjList[i]->end()) {
-          // Iterate over all the edges emanating out of the current vertex.
-          for (const auto &edge : adjItr->second) {
-            if (relaxed[i].find(edge.first) == relaxed[i].end()) {
-              // Find the destination of the edge in the ipq.
-              // Make find return INFINITE cost if not present.
-              const auto invc = std::make_pair(edge.first, INFINITE);
-              const auto vc = ipq[i].find(invc, invc);
-              // Relax.
-              if (cur_vc.second + edge.second < vc.second) {
-                // If the vertex is already present in the ipq, push will update
-                // its cost and reposition it in the priority queue based on the
-                // updated cost.
-                ipq[i].push(
-                    std::make_pair(edge.first, cur_vc.second + edge.second));
-                parents[i][edge.first] = cur_vc.first;
-                delta[i][edge.first] = cur_vc.second + edge.second;
-              }
-            }
+        // Iterate over all the edges emanating out of the current vertex.
+        for (const auto &edge : (*edges[i])[u]) {
+          const size_t v = edge.first;
+          const auto cost = cur_vc.second + edge.second;
+          if (!queued[i][v]) {
+            // First time reached: INFINITE cost so far.
+            COUNT_EVENT("bd_dijkstra.relaxations");
+            handles[i][v] = ipq[i].push(std::make_pair(mNames[v], cost));
+            queued[i][v] = true;
+          } else if (ipq[i].contains(handles[i][v]) &&
+                     cost < ipq[i].priority(handles[i][v]).second) {
+            // Relax. The handle repositions the vertex in the priority
+            // queue based on the updated cost, which is written in place:
+            // the vertex is neither copied nor looked up again.
+            COUNT_EVENT("bd_dijkstra.relaxations");
+            ipq[i].decrease_key(handles[i][v], cost);
+          } else {
+            continue;
           }
+          parents[i][v] = u;
+          delta[i][v] = cost;
         }
       }
       // All IPQs are empty.
@@ -165,47 +253,52 @@ public:
 
     // Find the common vertex in both forward and backward directions with
     // minimum cost.
-    vertex_t min_common_vertex;
+    size_t min_common_vertex = NONE;
     int min_common_vertex_cost = INFINITE;
-    for (const auto &vcf : delta[FORWARD]) {
-      auto dbi = delta[BACKWARD].find(vcf.first);
-      if (dbi != delta[BACKWARD].end()) {
-        if (vcf.second + dbi->second < min_common_vertex_cost) {
-          min_common_vertex = vcf.first;
-          min_common_vertex_cost = vcf.second + dbi->second;
-        }
+    for (size_t v = 0; v < n; ++v) {
+      if (delta[FORWARD][v] == INFINITE || delta[BACKWARD][v] == INFINITE)
+        continue;
+      if (delta[FORWARD][v] + delta[BACKWARD][v] < min_common_vertex_cost) {
+        min_common_vertex = v;
+        min_common_vertex_cost = delta[FORWARD][v] + delta[BACKWARD][v];
       }
     }
 
-    if (min_common_vertex_cost == INFINITE) {
-      std::cout << "No paths from: " << src << " to " << dst << std::endl;
-      return;
-    }
+    if (min_common_vertex_cost == INFINITE)
+      return INFINITE;
 
-    // Construct and print the shortest paths by following the parent links.
+    // Construct the shortest paths by following the parent links.
     // Inf forward direction : src to min_common_vertex.
     // Inf backward direction : from min_common_vertex to dst.
     // Combine the results.
-    std::cout << "Shortest paths from: " << src << " to " << dst << std::endl;
-    vertex_t s[NDIR] = {src, dst};
-    vertex_t d[NDIR] = {min_common_vertex, min_common_vertex};
-    path_t path;
     for (auto i = 0; i < NDIR; ++i) {
       path_t spath;
-      for (auto v = d[i]; v != s[i]; v = parents[i][v]) {
+      for (auto v = min_common_vertex; v != s[i]; v = parents[i][v]) {
         if (i == FORWARD)
-          spath.push_front(v);
+          spath.push_front(mNames[v]);
         else
-          spath.push_front(parents[i][v]);
+          spath.push_back(mNames[parents[i][v]]);
       }
 
       path.splice(path.end(), spath);
     }
     path.push_front(src);
 
-    for (const auto vp : path)
-      std::cout << vp << " ";
-    std::cout << std::endl;
+    return min_common_vertex_cost;
+  }
+
+  // Print the result of bd_dijkstra.
+  static void print_path(std::ostream &os, const vertex_t &src,
+                         const vertex_t &dst, const path_t &path) {
+    if (path.empty()) {
+      os << "No paths from: " << src << " to " << dst << std::endl;
+      return;
+    }
+
+    os << "Shortest paths from: " << src << " to " << dst << std::endl;
+    for (const auto &vp : path)
+      os << vp << " ";
+    os << std::endl;
   }
 
   friend std::ostream &operator<<(std::ostream &os, const Graph &g);
@@ -234,7 +327,58 @@ int main() {
   std::cout << "Graph: " << std::endl << g << std::endl;
 
   // Bidirectional Dijkstra's.
-  g.bd_dijkstra("S", "T");
+  Graph::path_t path;
+  g.bd_dijkstra("S", "T", path);
+  Graph::print_path(std::cout, "S", "T", path);
+
+  // Bidirectional Dijkstra's with pairing heaps.
+  g.bd_dijkstra<Graph::pairing_heap_t>("S", "T", path);
+  Graph::print_path(std::cout, "S", "T", path);
+
+  // Bidirectional Dijkstra's with radix heaps.
+  g.bd_dijkstra<Graph::radix_heap_t>("S", "T", path);
+  Graph::print_path(std::cout, "S", "T", path);
+  std::cout << std::endl;
+
+  // Head to head on a large sparse random graph.
+  const size_t V = 20000;
+  const size_t E = 4 * V;
+  Graph lg(Graph::DIRECTED);
+  xoshiro256 rng;
+  for (size_t i = 0; i < E; ++i)
+    lg.add_edge(std::to_string(rng.bounded(V)), std::to_string(rng.bounded(V)),
+                rng.uniform(1, 1000));
+
+  const std::string src = "0";
+  const std::string dst = std::to_string(V - 1);
+  const int cost = lg.bd_dijkstra(src, dst, path);
+  if (lg.bd_dijkstra<Graph::pairing_heap_t>(src, dst, path) != cost) {
+    std::cout << "Mismatch between binary heap and pairing heap." << std::endl;
+    return 1;
+  }
+  if (lg.bd_dijkstra<Graph::radix_heap_t>(src, dst, path) != cost) {
+    std::cout << "Mismatch between binary heap and radix heap." << std::endl;
+    return 1;
+  }
 
-  return 0;
+  std::cout << "Bidirectional Dijkstra on a random graph, V = " << V
+            << ", E = " << E << ", cost = " << cost << std::endl;
+  benchmark bm(benchmark::config_t(1, 11));
+  bench_baseline bl;
+  bl.add(bm.run("bd_dijkstra<ipq_t>",
+                [&]() { return lg.bd_dijkstra<Graph::ipq_t>(src, dst, path); }),
+         V);
+  bl.add(bm.run("bd_dijkstra<pairing_heap_t>",
+                [&]() {
+                  return lg.bd_dijkstra<Graph::pairing_heap_t>(src, dst, path);
+                }),
+         V);
+  bl.add(bm.run("bd_dijkstra<radix_heap_t>",
+                [&]() {
+                  return lg.bd_dijkstra<Graph::radix_heap_t>(src, dst, path);
+                }),
+         V);
+  bm.print(std::cout);
+
+  return bl.finish_from_env(std::cout) ? 1 : 0;
 }
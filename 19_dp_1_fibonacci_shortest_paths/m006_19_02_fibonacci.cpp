@@ -6,6 +6,8 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include "bench_baseline.hpp"
+#include "benchmark.hpp"
 #include "exec_time.hpp"
 #include <iostream>
 #include <unordered_map>
@@ -34,15 +36,41 @@ int main() {
 
   auto n = 45;
 
-  // Captures execution time.
-  exec_time et;
+  // Captures execution time and hardware counters, if available.
+  exec_time et(exec_time::WITH_COUNTERS);
+
+  // Results, saved or compared to a baseline on request (see
+  // bench_baseline.hpp).
+  bench_baseline bl;
 
   std::cout << "fib_rec(" << n << ")" << std::endl;
   std::cout << "Result = " << et(fib_rec, n)
-            << ". Time = " << et.get() << " ms." << std::endl << std::endl;
+            << ". Time = " << et.get() << " ms." << std::endl;
+  std::cout << et.counters() << std::endl << std::endl;
+  bl.add("fib_rec", n, et.get(), et.counters());
 
   std::cout << "fib_memoized(" << n << ")" << std::endl;
   std::cout << "Result = "<< et(fib_memoized, n)
             << ". Time = " << et.get() << " ms." << std::endl;
-  return 0;
+  std::cout << et.counters() << std::endl << std::endl;
+  bl.add("fib_memoized", n, et.get(), et.counters());
+
+  // A single capture is too coarse for the memoized lookups; take repeated
+  // batched samples instead.
+  benchmark bm(benchmark::config_t(3, 31, 1000));
+  bl.add(bm.run("fib_rec(20)", fib_rec, 20), 20);
+  bl.add(bm.run("fib_memoized(45)", fib_memoized, n), n);
+  bl.add(bm.run("fib_memoized(45) lambda", [n]() { return fib_memoized(n); }),
+         n);
+
+  // Time stamp counter: cheap enough to time each call individually.
+  bm.set_config(benchmark::config_t(3, 1001, 1));
+  bl.add(bm.run("fib_memoized(45) chrono", fib_memoized, n), n);
+  bl.add(bm.run<tsc_exec_time>("fib_memoized(45) tsc", fib_memoized, n), n);
+  bm.print(std::cout);
+  std::cout << std::endl;
+  bm.write_csv(std::cout);
+  std::cout << std::endl;
+
+  return bl.finish_from_env(std::cout) ? 1 : 0;
 }
@@ -45,24 +45,31 @@ void extract_file_words(const std::string &fname, word_list_t &wl) {
   }
 }
 
-// Returns the width of list of words starting at 'from' upto, but not
-// including, 'to' in the word list.
-size_t word_sublist_width(const word_list_t &wl, size_t from, size_t to) {
-  size_t nc = 0, nw = 0;
-  for (auto i = from; i < to; ++i) {
-    nc += wl[i].size();
-    ++nw;
-  }
+// Prefix widths of a word list: element i is the number of characters in
+// the words before the word at i.
+typedef std::vector<size_t> prefix_width_t;
+
+void word_prefix_widths(const word_list_t &wl, prefix_width_t &pw) {
+  pw.assign(wl.size() + 1, 0);
+  for (size_t i = 0; i < wl.size(); ++i)
+    pw[i + 1] = pw[i] + wl[i].size();
+}
 
-  if (nw > 0)
-    --nw; // No space after the last word.
-  return nc + nw;
+// Returns the width of list of words starting at 'from' upto, but not
+// including, 'to' in the word list. O(1) from the prefix widths, so the DP
+// stays O(n^2).
+size_t word_sublist_width(const prefix_width_t &pw, size_t from, size_t to) {
+  if (to <= from)
+    return 0;
+  // No space after the last word.
+  return pw[to] - pw[from] + (to - from - 1);
 }
 
 // Returns how bad is the look of a line that includes the words at 'from' upto,
 // but not including, 'to' in the word list.
-size_t badness(const word_list_t &wl, size_t from, size_t to, size_t width) {
-  const auto slw = word_sublist_width(wl, from, to);
+size_t badness(const prefix_width_t &pw, size_t from, size_t to,
+               size_t width) {
+  const auto slw = word_sublist_width(pw, from, to);
   if (slw > width) // Exceeding the width is prohibited.
     return INFINITE;
 
@@ -78,6 +85,8 @@ void text_justify(const std::string &fname, size_t width) {
     return;
 
   const ssize_t N = wl.size();
+  prefix_width_t pw;
+  word_prefix_widths(wl, pw);
 
   // DP table. Stores the minimum badness of text that starts a line at the word
   // at the same index in the word table.
@@ -96,7 +105,7 @@ void text_justify(const std::string &fname, size_t width) {
     next_line_start[i] = N;
     for (auto j = i + 1; j <= N; ++j) {
       // Calculate the total badness at i if the next line starts at j.
-      auto bad = badness(wl, i, j, width) + min_badness[j];
+      auto bad = badness(pw, i, j, width) + min_badness[j];
       if (bad < min_badness[i]) {
         min_badness[i] = bad;
         next_line_start[i] = j;
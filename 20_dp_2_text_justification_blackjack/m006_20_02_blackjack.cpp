@@ -6,9 +6,12 @@
 // in the file LICENSE in the source distribution.
 //
 
+#include <algorithm>
 #include <iostream>
 #include <list>
 
+#include "rng.hpp"
+
 #define NCVALS 13
 
 // Represent a card using a card number (1 - 13) and a
@@ -180,9 +183,8 @@ int main() {
       deck[t * NCVALS + n - 1] = std::make_pair(n, static_cast<card_type_t>(t));
 
   // Shuffle.
-  srand(time(0));
-  for (auto i = 0u; i < DECKSZ; ++i)
-    std::swap(deck[i], deck[rand() % DECKSZ]);
+  xoshiro256 rng(time(0));
+  std::shuffle(deck, deck + DECKSZ, rng);
 
   for (auto i = 0u; i < DECKSZ; ++i)
     std::cout << deck[i] << " ";
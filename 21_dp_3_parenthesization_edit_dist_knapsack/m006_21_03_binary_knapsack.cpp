@@ -10,6 +10,8 @@
 #include <iostream>
 #include <string>
 
+#include "rng.hpp"
+
 #define MIN_WEIGHT 1
 #define MAX_WEIGHT 10
 
@@ -63,7 +65,9 @@ void knapsack_dp(size_t S, const item_t *items, size_t N) {
 
 }
 
-size_t rand_num(size_t from, size_t to) { return from + rand() % (to - from); }
+size_t rand_num(xoshiro256 &rng, size_t from, size_t to) {
+  return from + rng.bounded(to - from);
+}
 
 int main() {
 
@@ -74,10 +78,10 @@ int main() {
   size_t S = (N * (MAX_WEIGHT + MIN_WEIGHT)) / 4;
 
   // Create a list of random items.
-  srand(time(0));
+  xoshiro256 rng(time(0));
   for (auto i = 0u; i < N; ++i) {
-    items[i].weight = rand_num(MIN_WEIGHT, MAX_WEIGHT);
-    items[i].profit = rand_num(MIN_PROFIT, MAX_PROFIT);
+    items[i].weight = rand_num(rng, MIN_WEIGHT, MAX_WEIGHT);
+    items[i].profit = rand_num(rng, MIN_PROFIT, MAX_PROFIT);
   }
 
   std::cout << "Knapsack Capacity: " << S << std::endl;
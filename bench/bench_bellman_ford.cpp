@@ -0,0 +1,36 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <string>
+
+#include "bench_graphs.hpp"
+#include "bench_suite.hpp"
+
+#define main bellman_ford_demo_main
+#include "../17_bellman_ford/m006_17_01_bellman_ford.cpp"
+#undef main
+
+// Single-source shortest paths on a sparse random graph. Bellman-Ford
+// relaxes every edge |V| - 1 times, so the graph is smaller than the one
+// of Dijkstra's.
+int main() {
+  bench_suite bs("bellman_ford");
+
+  const size_t V = bench_suite::scaled(1 << 10);
+  Graph g(Graph::DIRECTED);
+  for (const auto &e : random_edges(V, 4 * V, 1000))
+    g.add_edge(std::to_string(e.src), std::to_string(e.dst), e.cost);
+
+  // The paths are printed.
+  bs.run("sssp_bellman_ford", V, [&]() {
+    bench_suite::mute_cout mute;
+    g.sssp_bellman_ford("0");
+  });
+
+  return bs.finish();
+}
@@ -0,0 +1,39 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <string>
+
+#include "bench_graphs.hpp"
+#include "bench_suite.hpp"
+
+#define main bfs_sssp_demo_main
+#include "../r15_shortest_paths/m6006_r15_01_bfs_sssp.cpp"
+#undef main
+
+// Shortest path between two vertices of a sparse random graph, by BFS on
+// the graph with every edge of cost w turned into a path of w edges. The
+// costs are small as they multiply the vertices.
+int main() {
+  bench_suite bs("bfs_sssp");
+
+  const size_t V = bench_suite::scaled(1 << 12);
+  Graph g(Graph::DIRECTED);
+  for (const auto &e : random_edges(V, 4 * V, 8))
+    add_weighted_edge(g, std::to_string(e.src), std::to_string(e.dst),
+                      e.cost);
+
+  const std::string src = "0";
+  const std::string dst = std::to_string(V - 1);
+  Graph::vertex_list_t path;
+  bs.run("find_shortest_path", V, [&]() {
+    path.clear();
+    g.find_shortest_path(src, dst, path);
+  });
+
+  return bs.finish();
+}
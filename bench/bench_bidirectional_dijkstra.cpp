@@ -0,0 +1,52 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <string>
+
+#include "bench_graphs.hpp"
+#include "bench_suite.hpp"
+
+#define main bidirectional_dijkstra_demo_main
+#include "../18_speeding_up_dijkstra/m006_18_01_bidirectional_dijkstra.cpp"
+#undef main
+
+// Shortest path between two vertices of a sparse random graph, with each
+// of the priority queues.
+int main() {
+  bench_suite bs("bidirectional_dijkstra");
+
+  const size_t V = bench_suite::scaled(1 << 15);
+  Graph g(Graph::DIRECTED);
+  for (const auto &e : random_edges(V, 4 * V, 1000))
+    g.add_edge(std::to_string(e.src), std::to_string(e.dst), e.cost);
+
+  const std::string src = "0";
+  const std::string dst = std::to_string(V - 1);
+  Graph::path_t path;
+  const int expected = g.bd_dijkstra(src, dst, path);
+  bool ok = true;
+
+  bs.run("bd_dijkstra<ipq_t>", V, [&]() {
+    ok = ok && (g.bd_dijkstra<Graph::ipq_t>(src, dst, path) == expected);
+  });
+  bs.run("bd_dijkstra<pairing_heap_t>", V, [&]() {
+    ok = ok &&
+         (g.bd_dijkstra<Graph::pairing_heap_t>(src, dst, path) == expected);
+  });
+  bs.run("bd_dijkstra<radix_heap_t>", V, [&]() {
+    ok = ok && (g.bd_dijkstra<Graph::radix_heap_t>(src, dst, path) == expected);
+  });
+
+  if (!ok) {
+    std::cout << "Mismatch between the priority queues." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
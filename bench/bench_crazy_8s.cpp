@@ -0,0 +1,43 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+
+// Blackjack, in bench_dp, has cards of its own.
+#define main crazy_8s_demo_main
+#include "../r19_dp_1_crazy_8s/m006_r19_01_crazy_8s.cpp"
+#undef main
+
+// Longest crazy subsequence of a random deck, by both the methods. The DP
+// tables are on the stack, which bounds the deck whatever the scale.
+int main() {
+  bench_suite bs("crazy_8s");
+
+  const size_t DECKSZ = std::min<size_t>(bench_suite::scaled(1 << 12), 1 << 16);
+  std::vector<card_t> deck(DECKSZ);
+  xoshiro256 rng(1);
+  for (auto &c : deck)
+    c = std::make_pair(1 + static_cast<int>(rng.bounded(NCVALS)),
+                       static_cast<card_type_t>(rng.bounded(NCTYPES)));
+
+  // The subsequences are printed.
+  bs.run("print_longest_craze_subseq", DECKSZ, [&]() {
+    bench_suite::mute_cout mute;
+    print_longest_craze_subseq(deck.data(), DECKSZ);
+  });
+  bs.run("print_longest_craze_subseq2", DECKSZ, [&]() {
+    bench_suite::mute_cout mute;
+    print_longest_craze_subseq2(deck.data(), DECKSZ);
+  });
+
+  return bs.finish();
+}
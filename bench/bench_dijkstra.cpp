@@ -0,0 +1,48 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <string>
+
+#include "bench_graphs.hpp"
+#include "bench_suite.hpp"
+
+#define main dijkstra_demo_main
+#include "../16_dijkstra/m006_16_01_dijkstra.cpp"
+#undef main
+
+// Single-source shortest paths on a sparse random graph, with each of the
+// priority queues.
+int main() {
+  bench_suite bs("dijkstra");
+
+  const size_t V = bench_suite::scaled(1 << 15);
+  Graph g(Graph::UNDIRECTED);
+  for (const auto &e : random_edges(V, 4 * V, 1000))
+    g.add_edge(std::to_string(e.src), std::to_string(e.dst), e.cost);
+
+  const auto expected = g.sssp_dijkstra("0").costs;
+  bool ok = true;
+
+  bs.run("sssp_dijkstra<ipq_t>", V, [&]() {
+    ok = ok && (g.sssp_dijkstra<Graph::ipq_t>("0").costs == expected);
+  });
+  bs.run("sssp_dijkstra<pairing_heap_t>", V, [&]() {
+    ok = ok && (g.sssp_dijkstra<Graph::pairing_heap_t>("0").costs == expected);
+  });
+  bs.run("sssp_dijkstra<radix_heap_t>", V, [&]() {
+    ok = ok && (g.sssp_dijkstra<Graph::radix_heap_t>("0").costs == expected);
+  });
+
+  if (!ok) {
+    std::cout << "Mismatch between the priority queues." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -0,0 +1,200 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+
+#define main doc_distance_demo_main
+#include "../02_doc_distance/m006_01_01_doc_distance.cpp"
+#undef main
+
+// A text of n words drawn from a vocabulary of random words.
+std::string random_text(xoshiro256 &rng, const std::vector<std::string> &voc,
+                        size_t n) {
+  std::string text;
+  for (size_t i = 0; i < n; ++i) {
+    text += voc[rng.bounded(voc.size())];
+    text += (i % 12 == 11) ? ".\n" : " ";
+  }
+  return text;
+}
+
+// The counting of words it replaced, for reference: lines read with
+// std::getline, words put together a character at a time into a
+// std::string and counted in a std::unordered_map.
+typedef std::unordered_map<std::string, int> string_freq_table_t;
+
+void string_count_word_frequency(std::istream &in, string_freq_table_t &ft) {
+  std::string line, word;
+  while (std::getline(in, line)) {
+    for (char c : line) {
+      if (std::isalnum(static_cast<unsigned char>(c))) {
+        word.push_back(static_cast<char>(std::tolower(c)));
+      } else if (!word.empty()) {
+        ++ft[word];
+        word.clear();
+      }
+    }
+    if (!word.empty()) {
+      ++ft[word];
+      word.clear();
+    }
+  }
+}
+
+// Angle of two such tables.
+double string_vector_angle(const string_freq_table_t &f1,
+                           const string_freq_table_t &f2) {
+  double f1f2 = 0.0, f1f1 = 0.0, f2f2 = 0.0;
+  for (const auto &p : f1) {
+    f1f1 += static_cast<double>(p.second) * p.second;
+    const auto i = f2.find(p.first);
+    if (i != f2.end())
+      f1f2 += static_cast<double>(p.second) * i->second;
+  }
+  for (const auto &p : f2)
+    f2f2 += static_cast<double>(p.second) * p.second;
+  return std::acos(f1f2 / std::sqrt(f1f1 * f2f2));
+}
+
+// Word counting of two documents of N words and the angle between them.
+int main() {
+  bench_suite bs("doc_distance");
+
+  const size_t N = bench_suite::scaled(1 << 20);
+  const size_t VOCABULARY = 1 << 14;
+
+  xoshiro256 rng(1);
+  std::vector<std::string> voc(VOCABULARY);
+  for (auto &w : voc)
+    for (auto len = rng.uniform(2, 10); len > 0; --len)
+      w.push_back('a' + rng.bounded(26));
+
+  const std::string doc1 = random_text(rng, voc, N);
+  const std::string doc2 = random_text(rng, voc, N);
+
+  freq_table_t ft1, ft2;
+  bs.run("count_word_frequency", N, [&]() {
+    ft1.clear();
+    count_word_frequency(doc1, ft1);
+  });
+  count_word_frequency(doc2, ft2);
+
+  thread_pool pool;
+  freq_table_t pft;
+  bs.run("count_word_frequency/pool", N, [&]() {
+    pft.clear();
+    count_word_frequency(doc1, pft, &pool);
+  });
+  bool same = (pft.size() == ft1.size());
+  ft1.for_each([&](const freq_table_t::entry_t &e) {
+    same = same && (pft.find(e.word, e.hash) == e.count);
+  });
+  if (!same) {
+    std::cout << "Word counts of the pool differ." << std::endl;
+    return 1;
+  }
+
+  string_freq_table_t sft;
+  bs.run("std::unordered_map/getline", N, [&]() {
+    std::istringstream in(doc1);
+    sft.clear();
+    string_count_word_frequency(in, sft);
+  });
+
+  // The same from a file, mapped.
+  char fname[] = "/tmp/bench_doc_distance_XXXXXX";
+  const int fd = mkstemp(fname);
+  if (fd < 0) {
+    std::cout << "Cannot create a temporary file." << std::endl;
+    return 1;
+  }
+  std::ofstream(fname) << doc1;
+  bs.run("count_file_word_frequency", N, [&]() {
+    ft1.clear();
+    count_file_word_frequency(fname, ft1);
+  });
+  close(fd);
+  unlink(fname);
+
+  bool ok = (sft.size() == ft1.size());
+  for (const auto &p : sft)
+    ok = ok && (ft1.find(p.first) == static_cast<uint64_t>(p.second));
+  if (!ok) {
+    std::cout << "Word counts differ." << std::endl;
+    return 1;
+  }
+
+  double angle = 0.0;
+  bs.run("vector_angle", ft1.size(),
+         [&]() { angle = vector_angle(ft1, ft2); });
+
+  // The angle of the reference counts, whatever the size of the documents.
+  string_freq_table_t sft2;
+  std::istringstream in2(doc2);
+  string_count_word_frequency(in2, sft2);
+  const double expected = string_vector_angle(sft, sft2);
+  if (!(std::abs(angle - expected) < 1e-9)) {
+    std::cout << "Unexpected angle: " << angle << std::endl;
+    return 1;
+  }
+
+  // A corpus of documents of DOC_WORDS words: all the angles, sequential
+  // and on the pool, and the nearest neighbors of every document. Each
+  // case makes docs^2 / 2 or docs^2 comparisons.
+  const size_t DOCS = bench_suite::scaled(256), DOC_WORDS = 1 << 10;
+  std::vector<std::string> texts(DOCS);
+  std::vector<freq_table_t> tables(DOCS);
+  for (size_t d = 0; d < DOCS; ++d) {
+    texts[d] = random_text(rng, voc, DOC_WORDS);
+    count_word_frequency(texts[d], tables[d]);
+  }
+  const double angle01 = vector_angle(tables[0], tables[DOCS > 1]);
+
+  std::vector<doc_vector_t> docs;
+  make_doc_vectors(tables, docs, &pool);
+
+  std::vector<double> angles, pangles;
+  const size_t PAIRS = DOCS * (DOCS - 1) / 2;
+  bs.run("all_pairs_angles", PAIRS, [&]() { all_pairs_angles(docs, angles); });
+  bs.run("all_pairs_angles/pool", PAIRS,
+         [&]() { all_pairs_angles(docs, pangles, &pool); });
+  std::vector<std::vector<neighbor_t>> nn;
+  bs.run("nearest_neighbors/pool", 2 * PAIRS,
+         [&]() { nearest_neighbors(docs, 8, nn, &pool); });
+
+  // The same angle as from the tables, and the nearest neighbor is the
+  // lowest of the row.
+  ok = (angles == pangles) && std::abs(angles[DOCS > 1] - angle01) < 1e-9;
+  for (size_t i = 0; ok && i < DOCS && DOCS > 1; ++i) {
+    double lowest = M_PI;
+    for (size_t j = 0; j < DOCS; ++j)
+      if (j != i)
+        lowest = std::min(lowest, angles[i * DOCS + j]);
+    ok = (nn[i][0].angle == lowest);
+  }
+  if (!ok) {
+    std::cout << "Corpus angles differ." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -0,0 +1,297 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "complexity_sweep.hpp"
+#include "rng.hpp"
+
+#define main fibonacci_demo_main
+#include "../19_dp_1_fibonacci_shortest_paths/m006_19_02_fibonacci.cpp"
+#undef main
+
+// The programs of the DP lectures share the name of their cost bound.
+#define main text_justify_demo_main
+#include "../20_dp_2_text_justification_blackjack/m006_20_01_text_justify.cpp"
+#undef main
+#undef INFINITE
+
+#define main blackjack_demo_main
+#include "../20_dp_2_text_justification_blackjack/m006_20_02_blackjack.cpp"
+#undef main
+
+#define main matrix_chain_demo_main
+#include "../21_dp_3_parenthesization_edit_dist_knapsack/m006_21_01_parenthesize_matrix_chain_multiply.cpp"
+#undef main
+
+#define main edit_distance_demo_main
+#include "../21_dp_3_parenthesization_edit_dist_knapsack/m006_21_02_edit_distance.cpp"
+#undef main
+#undef INFINITE
+
+#define main knapsack_demo_main
+#include "../21_dp_3_parenthesization_edit_dist_knapsack/m006_21_03_binary_knapsack.cpp"
+#undef main
+
+#define main lis_demo_main
+#include "../r20_dp_2_longest_increasing_subsequence/m006_r20_01_lc_increasing_subseq.cpp"
+#undef main
+
+#define main ddr_demo_main
+#include "../r21_dance_dance_rev/m006_r21_01_ddr.cpp"
+#undef main
+
+// Write n random words, ten a line, for text_justify.
+static void write_words(const std::string &fname, size_t n, xoshiro256 &rng) {
+  std::ofstream ofs(fname);
+  for (size_t i = 0; i < n; ++i)
+    ofs << std::string(rng.uniform(1, 10), 'a' + rng.bounded(26))
+        << ((i % 10 == 9) ? "\n" : " ");
+}
+
+// Growth of the DP solvers with their input. The fitted exponent must stay
+// below the one of the solver's complexity plus a margin, so that an
+// accidental extra factor of n fails the run. The sizes are those the
+// stack-allocated DP tables allow and do not scale. fib_rec is exponential
+// by design and fib_memoized keeps its memo across calls: neither has an
+// exponent to check. Returns false if a solver grows too fast.
+static bool check_growth(xoshiro256 &rng) {
+  const double MARGIN = 0.5;
+  bool ok = true;
+  std::cout << "Growth of the DP solvers:" << std::endl;
+
+  // O(n^2): n^2 / 2 candidate lines, each of O(1) width from the prefix
+  // widths.
+  const std::string text_file = "bench_text_justify_sweep.txt";
+  const complexity_sweep words(complexity_sweep::config_t(1 << 9, 1 << 13));
+  const auto tj = words.run(
+      "text_justify",
+      [&](size_t n) {
+        write_words(text_file, n, rng);
+        return text_file;
+      },
+      [](const std::string &fname) {
+        bench_suite::mute_cout mute;
+        text_justify(fname, 60);
+      });
+  std::remove(text_file.c_str());
+  ok = complexity_sweep::check(std::cout, tj, 2 + MARGIN) && ok;
+
+  // O(n^2): a round stops at the first bust, so playing it is O(1).
+  const complexity_sweep cards(complexity_sweep::config_t(1 << 7, 1 << 10));
+  const auto bj = cards.run(
+      "blackjack_play_dp",
+      [&](size_t n) {
+        std::vector<card_t> deck(n);
+        for (auto &c : deck)
+          c = std::make_pair(1 + static_cast<int>(rng.bounded(NCVALS)),
+                             static_cast<card_type_t>(rng.bounded(NCTYPES)));
+        return deck;
+      },
+      [](const std::vector<card_t> &deck) {
+        bench_suite::mute_cout mute;
+        blackjack_play_dp(deck.data(), deck.size());
+      });
+  ok = complexity_sweep::check(std::cout, bj, 2 + MARGIN) && ok;
+
+  // O(n^3).
+  const complexity_sweep chain(complexity_sweep::config_t(1 << 6, 1 << 9));
+  const auto mc = chain.run(
+      "dp_matrix_chain_mult_order",
+      [&](size_t n) {
+        std::vector<size_t> dimension(n + 1);
+        for (auto &d : dimension)
+          d = rng.uniform(1, 100);
+        return dimension;
+      },
+      [](const std::vector<size_t> &dimension) {
+        return dp_matrix_chain_mult_order(dimension.data(),
+                                          dimension.size() - 1);
+      });
+  ok = complexity_sweep::check(std::cout, mc, 3 + MARGIN) && ok;
+
+  // O(n^2) for two strings of n characters.
+  const complexity_sweep chars(complexity_sweep::config_t(1 << 6, 1 << 9));
+  const auto ed = chars.run(
+      "edit_distance_dp",
+      [&](size_t n) {
+        std::pair<std::string, std::string> xy(std::string(n, ' '),
+                                               std::string(n, ' '));
+        for (auto &c : xy.first)
+          c = 'A' + rng.bounded(4);
+        for (auto &c : xy.second)
+          c = 'A' + rng.bounded(4);
+        return xy;
+      },
+      [](const std::pair<std::string, std::string> &xy) {
+        bench_suite::mute_cout mute;
+        edit_distance_dp(xy.first, xy.second, edit_cost);
+      });
+  ok = complexity_sweep::check(std::cout, ed, 2 + MARGIN) && ok;
+
+  // O(n S), with a capacity S proportional to n: O(n^2).
+  const complexity_sweep knap(complexity_sweep::config_t(1 << 5, 1 << 8));
+  const auto ks = knap.run(
+      "knapsack_dp",
+      [&](size_t n) {
+        std::vector<item_t> items(n);
+        for (auto &it : items) {
+          it.weight = rand_num(rng, MIN_WEIGHT, MAX_WEIGHT);
+          it.profit = rand_num(rng, MIN_PROFIT, MAX_PROFIT);
+        }
+        return items;
+      },
+      [](const std::vector<item_t> &items) {
+        bench_suite::mute_cout mute;
+        knapsack_dp((items.size() * (MAX_WEIGHT + MIN_WEIGHT)) / 4,
+                    items.data(), items.size());
+      });
+  ok = complexity_sweep::check(std::cout, ks, 2 + MARGIN) && ok;
+
+  // O(n^2).
+  const complexity_sweep seq(complexity_sweep::config_t(1 << 10, 1 << 14));
+  const auto lis = seq.run(
+      "print_longest_increasing_subseq",
+      [&](size_t n) {
+        std::vector<int> nums(n);
+        for (auto &x : nums)
+          x = rng.bounded(1 << 20);
+        return nums;
+      },
+      [](const std::vector<int> &nums) {
+        bench_suite::mute_cout mute;
+        print_longest_increasing_subseq(nums.data(), nums.size());
+      });
+  ok = complexity_sweep::check(std::cout, lis, 2 + MARGIN) && ok;
+
+  // O(n).
+  const complexity_sweep song(complexity_sweep::config_t(1 << 8, 1 << 12));
+  const auto ddr = song.run(
+      "ddr_dp",
+      [](size_t n) {
+        std::vector<note_t> notes(n);
+        for (auto &x : notes)
+          x = rand_note();
+        return notes;
+      },
+      [](const std::vector<note_t> &notes) {
+        bench_suite::mute_cout mute;
+        ddr_dp(notes.data(), notes.size(), distance);
+      });
+  ok = complexity_sweep::check(std::cout, ddr, 1 + MARGIN) && ok;
+
+  std::cout << std::endl;
+  return ok;
+}
+
+// The DP solvers on random inputs. Most of them keep their DP tables on the
+// stack, which bounds their input whatever the scale; the ones that print
+// their solution have it discarded.
+int main() {
+  bench_suite bs("dp");
+  xoshiro256 rng(1);
+
+  // Exponential: the input is the argument.
+  const int FIB_N = 30;
+  long fib = 0;
+  bs.run("fib_rec", FIB_N, [&]() { fib = fib_rec(FIB_N); });
+
+  // O(n^2): the lines are tried at every word.
+  const size_t N_WORDS = std::min<size_t>(bench_suite::scaled(1 << 9), 1 << 16);
+  const std::string text_file = "bench_text_justify.txt";
+  write_words(text_file, N_WORDS, rng);
+  bs.run("text_justify", N_WORDS, [&]() {
+    bench_suite::mute_cout mute;
+    text_justify(text_file, 60);
+  });
+  std::remove(text_file.c_str());
+
+  // O(n^2): every number of hits of every round is played out, up to the
+  // first bust.
+  const size_t DECKSZ = std::min<size_t>(bench_suite::scaled(1 << 8), 1 << 16);
+  std::vector<card_t> deck(DECKSZ);
+  for (auto &c : deck)
+    c = std::make_pair(1 + static_cast<int>(rng.bounded(NCVALS)),
+                       static_cast<card_type_t>(rng.bounded(NCTYPES)));
+  bs.run("blackjack_play_dp", DECKSZ, [&]() {
+    bench_suite::mute_cout mute;
+    blackjack_play_dp(deck.data(), DECKSZ);
+  });
+
+  // O(n^3).
+  const size_t N_MATRICES =
+      std::min<size_t>(bench_suite::scaled(1 << 8), 1 << 9);
+  std::vector<size_t> dimension(N_MATRICES + 1);
+  for (auto &d : dimension)
+    d = rng.uniform(1, 100);
+  std::string order;
+  bs.run("dp_matrix_chain_mult_order", N_MATRICES, [&]() {
+    order = dp_matrix_chain_mult_order(dimension.data(), N_MATRICES);
+  });
+
+  // O(n^2) for two strings of n characters.
+  const size_t N_CHARS = std::min<size_t>(bench_suite::scaled(1 << 9), 1 << 9);
+  std::string x(N_CHARS, ' '), y(N_CHARS, ' ');
+  for (auto &c : x)
+    c = 'A' + rng.bounded(4);
+  for (auto &c : y)
+    c = 'A' + rng.bounded(4);
+  bs.run("edit_distance_dp", N_CHARS, [&]() {
+    bench_suite::mute_cout mute;
+    edit_distance_dp(x, y, edit_cost);
+  });
+
+  // O(n S) for n items and a capacity S, which grows with n.
+  const size_t N_ITEMS = std::min<size_t>(bench_suite::scaled(1 << 8), 1 << 8);
+  const size_t S = (N_ITEMS * (MAX_WEIGHT + MIN_WEIGHT)) / 4;
+  std::vector<item_t> items(N_ITEMS);
+  for (auto &it : items) {
+    it.weight = rand_num(rng, MIN_WEIGHT, MAX_WEIGHT);
+    it.profit = rand_num(rng, MIN_PROFIT, MAX_PROFIT);
+  }
+  bs.run("knapsack_dp", N_ITEMS, [&]() {
+    bench_suite::mute_cout mute;
+    knapsack_dp(S, items.data(), N_ITEMS);
+  });
+
+  // O(n^2).
+  const size_t N_NUMS = std::min<size_t>(bench_suite::scaled(1 << 13), 1 << 16);
+  std::vector<int> nums(N_NUMS);
+  for (auto &n : nums)
+    n = rng.bounded(1 << 20);
+  bs.run("print_longest_increasing_subseq", N_NUMS, [&]() {
+    bench_suite::mute_cout mute;
+    print_longest_increasing_subseq(nums.data(), N_NUMS);
+  });
+
+  // O(n) for n notes, with a constant of the number of foot positions to
+  // the fourth.
+  const size_t N_NOTES =
+      std::min<size_t>(bench_suite::scaled(1 << 12), 1 << 12);
+  std::vector<note_t> notes(N_NOTES);
+  for (auto &n : notes)
+    n = rand_note();
+  bs.run("ddr_dp", N_NOTES, [&]() {
+    bench_suite::mute_cout mute;
+    ddr_dp(notes.data(), N_NOTES, distance);
+  });
+
+  // Keep the results alive.
+  if (fib < 0 || order.empty())
+    return 1;
+
+  if (!check_growth(rng))
+    return 1;
+
+  return bs.finish();
+}
@@ -0,0 +1,33 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include "bench_graphs.hpp"
+#include "bench_suite.hpp"
+
+#define main dp_sssp_demo_main
+#include "../19_dp_1_fibonacci_shortest_paths/m006_19_01_dp_sssp.cpp"
+#undef main
+
+// Single-source shortest paths on a sparse random graph held in an
+// adjacency matrix: |V| - 1 rounds over all the |V|^2 entries.
+int main() {
+  bench_suite bs("dp_sssp");
+
+  const size_t V = bench_suite::scaled(1 << 9);
+  Graph g(Graph::DIRECTED, V);
+  for (const auto &e : random_edges(V, 4 * V, 1000))
+    g.add_edge(e.src, e.dst, e.cost);
+
+  // The paths are printed.
+  bs.run("sssp_dp", V, [&]() {
+    bench_suite::mute_cout mute;
+    g.sssp_dp(0);
+  });
+
+  return bs.finish();
+}
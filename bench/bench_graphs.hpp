@@ -0,0 +1,40 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rng.hpp"
+
+// Random sparse graphs for the shortest path programs of the benchmark
+// suite. Each lecture program has a Graph class of its own; the edges are
+// added to it one by one, with the vertices named as the program needs.
+// Programs that only need integer vertices use int_graph.hpp instead.
+struct bench_edge_t {
+  size_t src;
+  size_t dst;
+  int cost;
+};
+
+// E edges between random vertices of [0, V), with costs uniform in
+// [1, max_cost]. The same arguments give the same graph.
+inline std::vector<bench_edge_t> random_edges(size_t V, size_t E,
+                                              int max_cost,
+                                              uint64_t seed = 1) {
+  std::vector<bench_edge_t> edges(E);
+  xoshiro256 rng(seed);
+  for (auto &e : edges) {
+    e.src = rng.bounded(static_cast<uint32_t>(V));
+    e.dst = rng.bounded(static_cast<uint32_t>(V));
+    e.cost = static_cast<int>(rng.uniform(1, max_cost));
+  }
+  return edges;
+}
@@ -0,0 +1,46 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+
+#define main hashing_with_chaining_demo_main
+#include "../08_hashing_with_chaining/m6006_08_01_hashing_with_chaining.cpp"
+#undef main
+
+// The table of the lecture only inserts: time filling a table sized for
+// the keys.
+template <typename HASHFUNC>
+void run_inserts(bench_suite &bs, const std::string &name,
+                 const std::vector<uint32_t> &keys) {
+  const auto n = static_cast<uint32_t>(keys.size());
+  bs.run(name + " insert", n, [&]() {
+    HashingWithChaining<HASHFUNC> ht(n);
+    for (auto k : keys)
+      ht.insert(k);
+  });
+}
+
+int main() {
+  bench_suite bs("hashing_with_chaining");
+
+  const size_t N = bench_suite::scaled(1 << 18);
+  std::vector<uint32_t> keys(N);
+  xoshiro256x4 rng(2147483647);
+  rng.fill_bounded(keys.data(), N, RAND_MAX);
+
+  run_inserts<DivisionHashFunction>(bs, "Division", keys);
+  run_inserts<MultiplicationHashFunction>(bs, "Multiplication", keys);
+  run_inserts<UniversalHashFunction>(bs, "Universal", keys);
+
+  return bs.finish();
+}
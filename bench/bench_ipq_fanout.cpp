@@ -0,0 +1,57 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_suite.hpp"
+
+#define main ipq_fanout_demo_main
+#include "../16_dijkstra/m006_16_03_ipq_fanout.cpp"
+#undef main
+
+// Dijkstra with the FANOUTs of indexed_priority_queue on a sparse graph
+// (pop dominated) and a dense one (decrease-key dominated). The default
+// FANOUT of the queue is the one that wins here, at -O2.
+template <size_t FANOUT>
+static bool run_fanout(bench_suite &bs, const std::string &graph,
+                       const int_graph &g, const std::vector<int> &expected) {
+  bool ok = true;
+  bs.run("sssp_dijkstra<" + std::to_string(FANOUT) + ">/" + graph,
+         g.num_vertices(),
+         [&]() { ok = ok && (sssp_dijkstra<FANOUT>(g, 0) == expected); });
+  return ok;
+}
+
+int main() {
+  bench_suite bs("ipq_fanout");
+
+  xoshiro256 rng;
+  const size_t SV = bench_suite::scaled(50000);
+  const int_graph sparse(SV, 4 * SV, rng);
+  const size_t DV = bench_suite::scaled(4000);
+  const int_graph dense(DV, 64 * DV, rng);
+
+  bool ok = true;
+  for (const auto *g : {&sparse, &dense}) {
+    const std::string name = (g == &sparse) ? "sparse" : "dense";
+    const auto expected = sssp_dijkstra<2>(*g, 0);
+    ok = run_fanout<2>(bs, name, *g, expected) && ok;
+    ok = run_fanout<4>(bs, name, *g, expected) && ok;
+    ok = run_fanout<8>(bs, name, *g, expected) && ok;
+    ok = run_fanout<16>(bs, name, *g, expected) && ok;
+  }
+
+  if (!ok) {
+    std::cout << "Mismatch between the fanouts." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
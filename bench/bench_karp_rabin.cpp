@@ -0,0 +1,50 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <string>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+
+#define main karp_rabin_demo_main
+#include "../09_table_doubling_karp_rabin/m6006_09_02_karp_rabin.cpp"
+#undef main
+
+// Substring search for the tail of a random text, which makes the search
+// roll through the whole text; std::string::find for reference.
+int main() {
+  bench_suite bs("karp_rabin");
+
+  const size_t N = bench_suite::scaled(1 << 22);
+  const size_t NEEDLE = 32;
+
+  xoshiro256 rng(1);
+  std::string haystack(N, ' ');
+  for (auto &c : haystack)
+    c = 'a' + rng.bounded(26);
+  const std::string needle = haystack.substr(N - NEEDLE);
+  const auto expected = static_cast<int32_t>(haystack.find(needle));
+
+  // False positives are printed.
+  bool ok = true;
+  bs.run("karp_rabin_strstr", N, [&]() {
+    bench_suite::mute_cout mute;
+    ok = ok && (karp_rabin_strstr(needle, haystack) == expected);
+  });
+  bs.run("std::string::find", N, [&]() {
+    ok = ok && (static_cast<int32_t>(haystack.find(needle)) == expected);
+  });
+
+  if (!ok) {
+    std::cout << "Needle not found." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
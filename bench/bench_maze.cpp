@@ -0,0 +1,57 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+
+#define main maze_demo_main
+#include "../13_breadth_first_search/m6006_13_01_maze.cpp"
+#undef main
+
+// BFS through a square maze with a quarter of the positions blocked at
+// random, from the top left to the bottom right corner. The top row and
+// the right column are kept open so that there is a way through.
+int main() {
+  bench_suite bs("maze");
+
+  const size_t SIDE = bench_suite::scaled(1 << 10);
+  const std::string maze_file = "bench_maze.txt";
+  {
+    std::ofstream ofs(maze_file);
+    xoshiro256 rng(1);
+    for (size_t i = 0; i < SIDE; ++i) {
+      std::string row(SIDE, ' ');
+      for (size_t j = 0; j < SIDE; ++j)
+        if (i > 0 && j < SIDE - 1 && rng.bounded(4) == 0)
+          row[j] = OBST;
+      if (i == 0)
+        row[0] = START;
+      if (i == SIDE - 1)
+        row[SIDE - 1] = END;
+      ofs << row << std::endl;
+    }
+  }
+
+  // Solving draws the trail on the board, which does not change later
+  // solutions.
+  MazeBoard m;
+  m.load(maze_file);
+  std::remove(maze_file.c_str());
+
+  bs.run("solve", SIDE * SIDE, [&]() { m.solve(); });
+
+  thread_pool pool;
+  bs.run("solve/pool", SIDE * SIDE, [&]() { m.solve(&pool); });
+
+  return bs.finish();
+}
@@ -0,0 +1,72 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <string>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+
+#define main karatsuba_newton_demo_main
+#include "../11_integer_arithmetic_karatsuba_multiplication/m6006_11_02_karatsuba_newton.cpp"
+#undef main
+
+// Products of two random numbers of N words, and a division of such a
+// product by one of the numbers. Newton's method takes many products of
+// growing size for a division, which gets a smaller input.
+int main() {
+  bench_suite bs("multiply");
+
+  const size_t N = bench_suite::scaled(1 << 9);
+  const size_t N_DIV = bench_suite::scaled(1 << 6);
+  magn::magnitude_t lhs(N), rhs(N);
+  xoshiro256 rng(1);
+  for (auto &w : lhs)
+    w = rng.next32();
+  for (auto &w : rhs)
+    w = rng.next32();
+
+  magn::magnitude_t expected = magn::high_school_multiply(lhs, rhs), prod;
+  bool ok = true;
+
+  bs.run("high_school_multiply", N,
+         [&]() { prod = magn::high_school_multiply(lhs, rhs); });
+  bs.run("dc_multiply", N, [&]() { prod = magn::dc_multiply(lhs, rhs); });
+  ok = ok && (prod == expected);
+  bs.run("karatsuba_multiply", N,
+         [&]() { prod = magn::karatsuba_multiply(lhs, rhs); });
+  ok = ok && (prod == expected);
+
+  thread_pool pool;
+  bs.run("karatsuba_multiply/pool", N,
+         [&]() { prod = magn::karatsuba_multiply(lhs, rhs, &pool); });
+  ok = ok && (prod == expected);
+
+  // Hex digits of 2 N_DIV and N_DIV words.
+  const magn::magnitude_t dlhs(lhs.begin(), lhs.begin() + N_DIV);
+  const magn::magnitude_t drhs(rhs.begin(), rhs.begin() + N_DIV);
+  std::string numer_hex, denom_hex;
+  magn::magnitude2hexstr(magn::high_school_multiply(dlhs, drhs), numer_hex);
+  magn::magnitude2hexstr(drhs, denom_hex);
+  const large_num_t numer(numer_hex), denom(denom_hex);
+  large_num_t quot;
+  bs.run("large_num_t::operator/", N_DIV, [&]() { quot = numer / denom; });
+  // The quotient is dlhs, but for leading zero words.
+  std::string lhs_hex;
+  magn::magnitude2hexstr(dlhs, lhs_hex);
+  const std::string quot_hex = quot.hex_str();
+  ok = ok && (lhs_hex.substr(lhs_hex.size() - quot_hex.size()) == quot_hex);
+
+  if (!ok) {
+    std::cout << "Multiplication failed." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -0,0 +1,68 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+
+#define main open_addressing_demo_main
+#include "../10_open_addressing_crypto_hashing/m6006_10_01_open_addressing.cpp"
+#undef main
+
+// Insert all the keys into a table that starts small, so that it grows on
+// the way, find them all, remove them all, for the table shrinks too.
+void run_probing(bench_suite &bs, const std::string &name,
+                 ProbingHashFunction &prh, const std::vector<uint32_t> &keys,
+                 bool &ok) {
+  bs.run(name, keys.size(), [&]() {
+    HashTable ht(prh);
+    for (auto k : keys)
+      ht.insert(k);
+    for (auto k : keys)
+      ok = ok && (ht.find(k) == k);
+    for (auto k : keys)
+      ht.remove(k);
+  });
+}
+
+int main() {
+  bench_suite bs("open_addressing");
+
+  const size_t N = bench_suite::scaled(1 << 18);
+  std::vector<uint32_t> keys(N);
+  xoshiro256x4 rng(A_BIG_PRIME_NUMBER);
+  rng.fill_bounded(keys.data(), N, RAND_MAX);
+
+  bool ok = true;
+
+  DivisionHashFunction div(N);
+  LinearProbingHashFunction div_lp(N, div);
+  run_probing(bs, "Linear % Division", div_lp, keys, ok);
+
+  MultiplicationHashFunction mult(N);
+  LinearProbingHashFunction mult_lp(N, mult);
+  run_probing(bs, "Linear % Multiplication", mult_lp, keys, ok);
+
+  UniversalHashFunction univ(N);
+  LinearProbingHashFunction univ_lp(N, univ);
+  run_probing(bs, "Linear % Universal", univ_lp, keys, ok);
+
+  UniversalHashFunction univ1(N), univ2(N);
+  DoubleHashFunction univ_dh(N, univ1, univ2);
+  run_probing(bs, "Double % Universal % Universal", univ_dh, keys, ok);
+
+  if (!ok) {
+    std::cout << "Hash table lost keys." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -0,0 +1,68 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "thread_pool.hpp"
+
+#define main linear_peak_finder_demo_main
+#include "../01_peak_finder/m006_01_01_linear_peak_finder.cpp"
+#undef main
+
+#define main dc_peak_finder_demo_main
+#include "../01_peak_finder/m006_01_02_dc_peak_finder.cpp"
+#undef main
+
+#define main all_peaks_finder_demo_main
+#include "../01_peak_finder/m006_01_05_all_peaks_finder.cpp"
+#undef main
+
+// One dimensional peak finding on an increasing array, whose only peak is
+// the last element: the worst case of the linear scan. all_peaks_finder
+// always scans the whole array, with each kernel the CPU runs.
+int main() {
+  bench_suite bs("peak_finder");
+
+  const size_t N = bench_suite::scaled(1 << 24);
+  std::vector<int> a(N);
+  std::iota(a.begin(), a.end(), 0);
+
+  const int expected = static_cast<int>(N) - 1;
+  bool ok = true;
+  bs.run("linear_peak_finder", N,
+         [&]() { ok = ok && (linear_peak_finder(a) == expected); });
+  bs.run("dc_peak_finder", N,
+         [&]() { ok = ok && (dc_peak_finder(a) == expected); });
+
+  const char *kernels[] = {"scalar", "sse2", "avx2"};
+  std::vector<uint64_t> mask;
+  auto found_last = [&]() {
+    return count_peaks(mask) == 1 && ((mask.back() >> ((N - 1) % 64)) & 1);
+  };
+  for (int k = PEAK_SCALAR; k <= best_peak_kernel(); ++k) {
+    const auto kernel = static_cast<peak_kernel_t>(k);
+    bs.run(std::string("all_peaks_finder/") + kernels[k], N,
+           [&]() { all_peaks_finder(a.data(), N, mask, nullptr, kernel); });
+    ok = ok && found_last();
+  }
+
+  thread_pool pool;
+  bs.run("all_peaks_finder/pool", N,
+         [&]() { all_peaks_finder(a.data(), N, mask, &pool); });
+  ok = ok && found_last();
+
+  if (!ok) {
+    std::cout << "Peak not found." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -0,0 +1,66 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+
+#define main range_min_demo_main
+#include "../r11_algo_design_principles/m6006_r11_01_range_min.cpp"
+#undef main
+
+// Pre-process, then query the minimum of every one of the n (n + 1) / 2
+// ranges, and sum the minimums.
+uint64_t all_range_mins(range_min &rmin) {
+  rmin.pre_process();
+  uint64_t sum = 0;
+  const ssize_t n = rmin.length();
+  for (ssize_t l = 0; l < n; ++l)
+    for (ssize_t h = l; h < n; ++h)
+      sum += rmin.find_range_min(l, h);
+  return sum;
+}
+
+int main() {
+  bench_suite bs("range_min");
+
+  const size_t N = bench_suite::scaled(1 << 10);
+  std::vector<uint32_t> nums(N);
+  xoshiro256 rng(1);
+  for (auto &x : nums)
+    x = rng.bounded(4 * N);
+
+  range_min_brute_force rbf(nums.data(), N);
+  const uint64_t expected = all_range_mins(rbf);
+  bool ok = true;
+
+  bs.run("range_min_brute_force", N, [&]() {
+    range_min_brute_force r(nums.data(), N);
+    ok = ok && (all_range_mins(r) == expected);
+  });
+  bs.run("range_min_dc", N, [&]() {
+    range_min_dc r(nums.data(), N);
+    ok = ok && (all_range_mins(r) == expected);
+  });
+
+  thread_pool pool;
+  bs.run("range_min_dc/pool", N, [&]() {
+    range_min_dc r(nums.data(), N, &pool);
+    ok = ok && (all_range_mins(r) == expected);
+  });
+
+  if (!ok) {
+    std::cout << "Range minimums differ." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
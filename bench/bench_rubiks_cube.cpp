@@ -0,0 +1,45 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+
+#define main rubiks_cube_demo_main
+#include "../r16_rubiks_cube/m6006_r16_01_rubiks_cube.cpp"
+#undef main
+
+// BFS solution of a cube jumbled up by a few random moves. The search
+// visits the positions up to the depth of the solution, whose number grows
+// about six fold per move.
+int main() {
+  bench_suite bs("rubiks_cube");
+
+  const size_t MOVES = 10;
+  RubiksCube r;
+  xoshiro256 rng(1);
+  for (size_t i = 0; i < MOVES; ++i)
+    r.apply_move(static_cast<RubiksCube::move_type_t>(
+        rng.bounded(RubiksCube::NUMMOVES)));
+
+  RubiksCube::move_sequence_t solution;
+  bs.run("get_solution", MOVES, [&]() {
+    solution.clear();
+    r.get_solution(solution);
+  });
+
+  for (const auto &m : solution)
+    r.apply_move(m);
+  if (!r.is_solved()) {
+    std::cout << "Cube not solved." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
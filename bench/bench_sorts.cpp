@@ -0,0 +1,105 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+
+#define main insertion_sort_demo_main
+#include "../03_insertion_merge_sort/m006_03_01_insertion_sort.cpp"
+#undef main
+
+#define main merge_sort_demo_main
+#include "../03_insertion_merge_sort/m006_03_02_merge_sort.cpp"
+#undef main
+
+#define main heap_sort_demo_main
+#include "../04_heaps_heap_sort/m006_04_01_heap_sort.cpp"
+#undef main
+
+#define main radix_sort_demo_main
+#include "../07_counting_radix_sort/m6006_07_02_radix_sort.cpp"
+#undef main
+
+// Sorts of random integers; std::sort for reference.
+int main() {
+  bench_suite bs("sorts");
+
+  // The quadratic sort gets a smaller input. radix_sort keeps its
+  // auxiliary array on the stack, which limits its input.
+  const size_t N = bench_suite::scaled(1 << 20);
+  const size_t N_QUADRATIC = bench_suite::scaled(1 << 14);
+  const size_t N_RADIX = std::min<size_t>(N, 1 << 18);
+
+  std::vector<int> input(N);
+  xoshiro256 rng(1);
+  for (auto &x : input)
+    x = rng.next32() >> 1;
+
+  std::vector<int> work;
+  bool ok = true;
+  auto check = [&](size_t n) {
+    std::vector<int> e(input.begin(), input.begin() + n);
+    std::sort(e.begin(), e.end());
+    ok = ok && std::equal(e.begin(), e.end(), work.begin());
+  };
+
+  bs.run("std::sort", N, [&]() {
+    work = input;
+    std::sort(work.begin(), work.end());
+  });
+
+  bs.run("binary_insertion_sort", N_QUADRATIC, [&]() {
+    work.assign(input.begin(), input.begin() + N_QUADRATIC);
+    binary_insertion_sort(work.data(), N_QUADRATIC);
+  });
+  check(N_QUADRATIC);
+
+  bs.run("two_way_merge_sort", N, [&]() {
+    work = input;
+    two_way_merge_sort(work.data(), N);
+  });
+  check(N);
+
+  thread_pool pool;
+  bs.run("two_way_merge_sort/pool", N, [&]() {
+    work = input;
+    two_way_merge_sort(work.data(), N, &pool);
+  });
+  check(N);
+
+  // heap_sort with a max-heap sorts in ascending order.
+  heap_store h;
+  bs.run("heap_sort", N, [&]() {
+    h.v = input;
+    h.len = static_cast<int>(N);
+    heap_sort(h, std::greater<int>());
+  });
+  work = h.v;
+  check(N);
+
+  std::vector<long> lwork;
+  bs.run("radix_sort", N_RADIX, [&]() {
+    lwork.assign(input.begin(), input.begin() + N_RADIX);
+    radix_sort(lwork.data(), N_RADIX);
+  });
+  work.assign(lwork.begin(), lwork.end());
+  check(N_RADIX);
+
+  if (!ok) {
+    std::cout << "Sort failed." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -0,0 +1,98 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "benchmark.hpp"
+
+// Support for the programs of the benchmark suite.
+//
+// The algorithms live in the single-file programs of the lecture
+// directories. A suite program pulls one in with its main renamed, e.g.
+//   #define main merge_sort_demo_main
+//   #include "../03_insertion_merge_sort/m006_03_02_merge_sort.cpp"
+//   #undef main
+// and times its functions on large inputs with the statistical benchmark
+// runner.
+//
+// Every result is printed and, if BENCH_REPORT names a file, appended to
+// it as a CSV row (case names have no commas)
+//   suite,case,n,median_ns,p90_ns,ns_per_n
+// so that 'make bench' can put the results of all the programs in one
+// report. Input sizes are multiplied by BENCH_SCALE (default 1), to go
+// beyond the defaults, which take seconds, or to get a quick smoke run.
+class bench_suite {
+private:
+  const std::string mName;
+  benchmark mBench;
+  std::ofstream mReport;
+
+public:
+  explicit bench_suite(const std::string &name,
+                       const benchmark::config_t &cfg = benchmark::config_t(1,
+                                                                            5))
+      : mName(name), mBench(cfg) {
+    const char *report = std::getenv("BENCH_REPORT");
+    if (report)
+      mReport.open(report, std::ios::app);
+    std::cout << "== " << mName << std::endl;
+  }
+
+  // The input size n scaled by BENCH_SCALE, at least 1.
+  static size_t scaled(size_t n) {
+    const char *scale = std::getenv("BENCH_SCALE");
+    const double s = scale ? std::atof(scale) : 1.0;
+    const double sn = n * s;
+    return (sn < 1.0) ? 1 : static_cast<size_t>(sn);
+  }
+
+  // Benchmark func, which processes an input of size n.
+  template <typename F>
+  const benchmark::result_t &run(const std::string &name, uint64_t n,
+                                 F &&func) {
+    const auto &r = mBench.run(name, func);
+    if (mReport) {
+      std::ostringstream row;
+      row << std::fixed << std::setprecision(1) << mName << "," << name
+          << "," << n << "," << r.median << "," << r.p90 << ","
+          << r.median / (n ? n : 1);
+      mReport << row.str() << std::endl;
+    }
+    return r;
+  }
+
+  // Print the results; the exit status of the program.
+  int finish() const {
+    mBench.print(std::cout);
+    std::cout << std::endl;
+    return 0;
+  }
+
+  // Discards what is written to std::cout in its scope, for algorithms
+  // which print their results. Without a buffer the stream fails the
+  // writes; restoring the buffer clears the error.
+  class mute_cout {
+  private:
+    std::streambuf *mSaved;
+
+  public:
+    mute_cout() : mSaved(std::cout.rdbuf(nullptr)) {}
+    ~mute_cout() { std::cout.rdbuf(mSaved); }
+
+    mute_cout(const mute_cout &) = delete;
+    mute_cout &operator=(const mute_cout &) = delete;
+  };
+};
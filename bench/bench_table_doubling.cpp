@@ -0,0 +1,72 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <cstdint>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+
+#define main table_doubling_demo_main
+#include "../09_table_doubling_karp_rabin/m6006_09_01_table_doubling.cpp"
+#undef main
+
+// Insert all the keys into a table that starts small, so that it doubles
+// on the way, find them all, remove them all. Returns the number of keys
+// found.
+template <typename TABLE>
+size_t insert_find_remove(const std::vector<uint32_t> &keys) {
+  TABLE ht;
+  for (auto k : keys)
+    ht.insert(k);
+  size_t found = 0;
+  for (auto k : keys)
+    found += (ht.find(k) == k);
+  for (auto k : keys)
+    ht.remove(k);
+  return found;
+}
+
+// std::unordered_set for reference.
+struct std_unordered_set {
+  std::unordered_set<uint32_t> s;
+  void insert(uint32_t k) { s.insert(k); }
+  uint32_t find(uint32_t k) const {
+    return s.count(k) ? k : UINT32_MAX;
+  }
+  void remove(uint32_t k) { s.erase(k); }
+};
+
+int main() {
+  bench_suite bs("table_doubling");
+
+  const size_t N = bench_suite::scaled(1 << 18);
+  std::vector<uint32_t> keys(N);
+  xoshiro256x4 rng(A_BIG_PRIME_NUMBER);
+  rng.fill_bounded(keys.data(), N, RAND_MAX);
+
+  typedef size_t (*ifr_t)(const std::vector<uint32_t> &);
+  bool ok = true;
+  auto run = [&](const char *name, ifr_t ifr) {
+    bs.run(name, N, [&]() { ok = ok && (ifr(keys) == N); });
+  };
+  run("Division", insert_find_remove<HashTable<DivisionHashFunction>>);
+  run("Multiplication",
+      insert_find_remove<HashTable<MultiplicationHashFunction>>);
+  run("Universal", insert_find_remove<HashTable<UniversalHashFunction>>);
+  run("std::unordered_set", insert_find_remove<std_unordered_set>);
+
+  if (!ok) {
+    std::cout << "Hash table lost keys." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -0,0 +1,46 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <iostream>
+#include <string>
+
+#include "bench_graphs.hpp"
+#include "bench_suite.hpp"
+
+#define main dfs_topo_sort_demo_main
+#include "../14_depth_first_search/m6006_14_01_dfs_topo_sort.cpp"
+#undef main
+
+// Topological sort, a DFS for back edges and one for the order, of a
+// sparse random DAG: the edges of a random graph directed from the lower
+// to the higher vertex.
+int main() {
+  bench_suite bs("topo_sort");
+
+  const size_t V = bench_suite::scaled(1 << 14);
+  Graph g(Graph::DIRECTED);
+  for (const auto &e : random_edges(V, 4 * V, 1)) {
+    if (e.src != e.dst)
+      g.add_edge(std::to_string(std::min(e.src, e.dst)),
+                 std::to_string(std::max(e.src, e.dst)));
+  }
+
+  bool ok = true;
+  Graph::vertex_list_t topo;
+  bs.run("topo_sort", V, [&]() {
+    topo.clear();
+    ok = ok && g.topo_sort(topo);
+  });
+
+  if (!ok) {
+    std::cout << "Topological sort failed." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
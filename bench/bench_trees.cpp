@@ -0,0 +1,100 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <set>
+#include <vector>
+
+#include "bench_suite.hpp"
+#include "rng.hpp"
+
+// Both programs have an interactive menu of the same name.
+#define main bst_demo_main
+#define PrintKey bst_print_key
+#define menu bst_menu
+#include "../05_bst_bst_sort/m006_05_01_bst.cpp"
+#undef main
+#undef PrintKey
+#undef menu
+#undef WDTH
+
+#define main avl_demo_main
+#define PrintKey avl_print_key
+#define menu avl_menu
+#include "../06_avl_avl_sort/m006_06_01_avl.cpp"
+#undef main
+#undef PrintKey
+#undef menu
+
+// Insert all the keys into an empty tree, find them all, remove them all.
+// Returns the number of keys found.
+template <class TREE> size_t insert_find_remove(const std::vector<int> &keys) {
+  TREE t;
+  for (auto k : keys)
+    t.insert(k);
+  size_t found = 0;
+  for (auto k : keys)
+    found += (t.find(k) != nullptr);
+  for (auto k : keys)
+    t.remove(k);
+  return found;
+}
+
+// std::set for reference.
+struct std_set {
+  std::set<int> s;
+  void insert(int v) { s.insert(v); }
+  const int *find(int v) const {
+    auto i = s.find(v);
+    return (i == s.end()) ? nullptr : &*i;
+  }
+  void remove(int v) { s.erase(v); }
+};
+
+// Random keys keep the BST about balanced; sorted keys make it a list and
+// its operations linear, so the sorted input is smaller.
+int main() {
+  bench_suite bs("trees");
+
+  const size_t N = bench_suite::scaled(1 << 18);
+  const size_t N_SORTED = bench_suite::scaled(1 << 12);
+
+  std::vector<int> random_keys(N);
+  xoshiro256 rng(1);
+  for (auto &k : random_keys)
+    k = rng.next32() >> 1;
+
+  std::vector<int> sorted_keys(N_SORTED);
+  std::iota(sorted_keys.begin(), sorted_keys.end(), 0);
+
+  // Every key must be found, duplicates too.
+  bool ok = true;
+  for (const auto *keys : {&random_keys, &sorted_keys}) {
+    const std::string input = (keys == &random_keys) ? "/random" : "/sorted";
+    const size_t n = keys->size();
+
+    bs.run("BinarySearchTree" + input, n, [&]() {
+      ok = ok && (insert_find_remove<BinarySearchTree>(*keys) == n);
+    });
+    bs.run("AVLTree" + input, n, [&]() {
+      ok = ok && (insert_find_remove<AVLTree>(*keys) == n);
+    });
+    bs.run("std::set" + input, n, [&]() {
+      ok = ok && (insert_find_remove<std_set>(*keys) == n);
+    });
+  }
+
+  if (!ok) {
+    std::cout << "Search tree lost keys." << std::endl;
+    return 1;
+  }
+
+  return bs.finish();
+}
@@ -17,9 +17,10 @@ CXXFLAGS := $(CXXFLAGS) \
 	-Woverloaded-virtual -Wctor-dtor-privacy \
 	-Wstrict-overflow=5 -Wswitch-default -Wundef \
 	-fno-elide-constructors \
+	-pthread \
 	-g
 
-TOPTARGETS := all clean format
+TOPTARGETS := all clean format bench
 
 SRCS = $(wildcard *.cpp)
 HDRS = $(wildcard *.hpp)
@@ -34,6 +35,10 @@ clean:
 format:
 	for srcfile in $(SRCS) $(HDRS) ; do $(CXXFORMAT) -i $${srcfile} ; done
 
+# Build and run the benchmark suite, see ../bench/Makefile.
+bench:
+	$(MAKE) -C ../bench run
+
 .PHONY: $(TOPTARGETS)
 
 .SUFFIXES: .ii .out
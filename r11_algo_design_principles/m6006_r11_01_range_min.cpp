@@ -7,11 +7,17 @@
 //
 
 #include <cassert>
-#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "bench_baseline.hpp"
+#include "complexity_sweep.hpp"
+#include "exec_time.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
 
 #define INVALID_MIN UINT32_MAX
 
@@ -44,6 +50,14 @@ protected:
 // of sub-arrays are calculated till a mid point is found such that i and j are
 // at either side of mid. min(subrange_min(i, mid), subrange_min(mid+1, j))
 // is the minimum for subrange (i, j).
+//
+// The table is split so that the pre-processing can run on a thread pool:
+// numbering the nodes of the recursion like a heap (root 1, children 2k and
+// 2k + 1), each node up to depth SHARD_DEPTH has a hash-map of its own, and
+// each deeper node uses the one of its ancestor at depth SHARD_DEPTH. The
+// two halves of a node then never write to the same hash-map and are
+// pre-processed in parallel. A query tracks the node number on its way
+// down to pick the hash-map.
 class range_min_dc : public range_min {
 protected:
   struct pair_hash {
@@ -56,13 +70,26 @@ protected:
   typedef std::unordered_map<std::pair<ssize_t, ssize_t>, uint32_t, pair_hash>
       range_min_table_t;
 
-  range_min_table_t rtable;
+  enum { SHARD_DEPTH = 6 };
+
+  // Hash-map of a child of the node of the given hash-map at the given
+  // depth.
+  static size_t child_shard(size_t shard, size_t depth, bool right) {
+    return (depth < SHARD_DEPTH) ? 2 * shard + right : shard;
+  }
+
+  // Indexed by the node number; [0] is unused.
+  std::vector<range_min_table_t> rtables;
+
+  thread_pool *pool;
 
-  void populate_min_range_table_recurse(ssize_t low, ssize_t high) {
+  void populate_min_range_table_recurse(ssize_t low, ssize_t high,
+                                        size_t shard, size_t depth) {
     // Base cases.
     if (low > high) {
       return;
     }
+    range_min_table_t &rtable = rtables[shard];
     if (low == high) {
       rtable[std::make_pair(low, high)] = nums[low];
       return;
@@ -86,16 +113,27 @@ protected:
       rtable[std::make_pair(mid + 1, i)] = lowest;
     }
 
-    // Recurse.
-    populate_min_range_table_recurse(low, mid);
-    populate_min_range_table_recurse(mid + 1, high);
+    // Recurse, in parallel as long as the halves have hash-maps of their
+    // own.
+    auto left = [=]() {
+      populate_min_range_table_recurse(
+          low, mid, child_shard(shard, depth, false), depth + 1);
+    };
+    auto right = [=]() {
+      populate_min_range_table_recurse(
+          mid + 1, high, child_shard(shard, depth, true), depth + 1);
+    };
+    parallel_invoke((depth < SHARD_DEPTH) ? pool : nullptr, left, right);
   }
 
 public:
-  range_min_dc(const uint32_t *_nums, uint32_t _N) : range_min(_nums, _N) {}
+  range_min_dc(const uint32_t *_nums, uint32_t _N,
+               thread_pool *_pool = nullptr)
+      : range_min(_nums, _N), rtables(size_t(2) << SHARD_DEPTH),
+        pool(_pool) {}
 
   virtual void pre_process() override {
-    populate_min_range_table_recurse(0, N - 1);
+    populate_min_range_table_recurse(0, N - 1, 1, 0);
   }
 
   virtual uint32_t find_range_min(ssize_t low, ssize_t high) const override {
@@ -109,12 +147,14 @@ public:
     }
 
     ssize_t ll = 0, hh = N - 1;
+    size_t shard = 1, depth = 0;
     while (ll < hh) {
       auto mid = (ll + hh) / 2;
       if (low <= mid && high > mid) {
         // low and high are at either side of mid.
         // minimum of subrange mins of the subranges (low, mid) and
         // (mid+1, high) is the answer.
+        const range_min_table_t &rtable = rtables[shard];
         auto itrl = rtable.find(std::make_pair(low, mid));
         if (itrl == rtable.end()) {
           assert(false);
@@ -129,9 +169,11 @@ public:
       } else if (high <= mid) {
         // Both low and high are on the left half; try there.
         hh = mid;
+        shard = child_shard(shard, depth++, false);
       } else {
         // Both low and high are on the right half; try there.
         ll = mid + 1;
+        shard = child_shard(shard, depth++, true);
       }
     }
 
@@ -140,9 +182,10 @@ public:
   }
 
   void dump_rtable(std::ostream &os) const {
-    for (const auto &e : rtable)
-      os << "[" << e.first.first << " : " << e.first.second
-         << "] = " << e.second << std::endl;
+    for (const auto &rtable : rtables)
+      for (const auto &e : rtable)
+        os << "[" << e.first.first << " : " << e.first.second
+           << "] = " << e.second << std::endl;
   }
 };
 
@@ -174,33 +217,51 @@ void print_nums(const uint32_t *nums, ssize_t N) {
 
 #define A_BIG_PRIME_NUMBER 2147483647 // srand seed
 
-double run_min_range_test(std::string msg, range_min &rmin) {
+double run_min_range_test(std::string msg, range_min &rmin,
+                          bench_baseline &bl) {
   std::cout << msg << ": length: " << rmin.length() << std::endl;
 
-  auto t1 = std::chrono::high_resolution_clock::now();
-  rmin.pre_process();
+  // Captures execution time and hardware counters, if available.
+  exec_time et(exec_time::WITH_COUNTERS);
+
+  {
+    TRACE_ZONE("pre_process");
+    exec_time::scope s(et);
+    rmin.pre_process();
+  }
+  const auto pre_time = et.get();
+  const auto pre_counters = et.counters();
 
-  auto t2 = std::chrono::high_resolution_clock::now();
   const auto N = rmin.length();
-  for (ssize_t l = 0; l < N; ++l) {
-    for (ssize_t h = l; h < N; ++h) {
-      auto res = rmin.find_range_min(l, h);
-      if (res == INVALID_MIN) {
-        std::cout << "Invalid min for range (" << l << ", " << h << ") "
-                  << std::endl;
+  {
+    TRACE_ZONE("queries");
+    exec_time::scope s(et);
+    for (ssize_t l = 0; l < N; ++l) {
+      for (ssize_t h = l; h < N; ++h) {
+        auto res = rmin.find_range_min(l, h);
+        if (res == INVALID_MIN) {
+          std::cout << "Invalid min for range (" << l << ", " << h << ") "
+                    << std::endl;
+        }
       }
     }
   }
-  auto t3 = std::chrono::high_resolution_clock::now();
+  const uint64_t num_queries = static_cast<uint64_t>(N) * (N + 1) / 2;
 
-  std::cout << "Preprocessing time: "
-            << (std::chrono::duration<double, std::milli>(t2 - t1)).count()
-            << std::endl;
-  std::cout << "Test time: "
-            << (std::chrono::duration<double, std::milli>(t3 - t2)).count()
-            << std::endl;
+  std::cout << "Preprocessing time: " << pre_time << std::endl;
+  if (et.has_counters()) {
+    pre_counters.print(std::cout, N);
+    std::cout << std::endl;
+  }
+  std::cout << "Test time: " << et.get() << std::endl;
+  bl.add(msg + " pre_process", N, pre_time, pre_counters);
+  bl.add(msg + " queries", N, et.get(), et.counters());
+  if (et.has_counters()) {
+    et.counters().print(std::cout, num_queries);
+    std::cout << std::endl;
+  }
 
-  return std::chrono::duration<double, std::milli>(t3 - t1).count();
+  return pre_time + et.get();
 }
 
 int main() {
@@ -213,22 +274,54 @@ int main() {
 
   // print_nums(nums, N);
 
-  // Test how much time finding min of all subranges take.
-  // First test with N/10 elements and then with all N elements.
-  // Check how dc and brute-force grow with this 10-fold growth
-  // in the number of elements.
+  // Results, saved or compared to a baseline on request (see
+  // bench_baseline.hpp).
+  bench_baseline bl;
 
+  // Test how much time finding min of all subranges take.
   range_min_dc rdc(nums, N / 10);
-  auto t1_part = run_min_range_test("Divide-and-Conquer", rdc);
-  range_min_dc rdc2(nums, N);
-  auto t1_full = run_min_range_test("Divide-and-Conquer", rdc2);
-  std::cout << "Growth: " << t1_full / t1_part << std::endl << std::endl;
+  run_min_range_test("Divide-and-Conquer", rdc, bl);
+  std::cout << std::endl;
+
+  // The same with the pre-processing spread over a thread pool.
+  thread_pool pool;
+  range_min_dc rdcp(nums, N / 10, &pool);
+  run_min_range_test("Divide-and-Conquer, pool", rdcp, bl);
+  std::cout << std::endl;
 
   range_min_brute_force rbf(nums, N / 10);
-  auto t2_part = run_min_range_test("Brute-Force", rbf);
-  range_min_brute_force rbf2(nums, N);
-  auto t2_full = run_min_range_test("Brute-Force", rbf2);
-  std::cout << "Growth: " << t2_full / t2_part << std::endl;
+  run_min_range_test("Brute-Force", rbf, bl);
+  std::cout << std::endl;
+
+  // Check how dc and brute-force grow with the number of elements.
+  // Finding min of all O(n^2) subranges is expected to take ~n^2 for dc and
+  // ~n^3 for brute-force.
+  complexity_sweep cs(complexity_sweep::config_t(N / 40, N / 5, 2.0, 3));
+  auto prefix_length = [](size_t n) { return n; };
+
+  auto dc_all = [&nums](size_t n) {
+    range_min_dc r(nums, n);
+    r.pre_process();
+    for (size_t l = 0; l < n; ++l)
+      for (size_t h = l; h < n; ++h)
+        r.find_range_min(l, h);
+  };
+  const auto dc_sweep = cs.run("Divide-and-Conquer", prefix_length, dc_all);
+  complexity_sweep::print(std::cout, dc_sweep);
+
+  auto bf_all = [&nums](size_t n) {
+    range_min_brute_force r(nums, n);
+    for (size_t l = 0; l < n; ++l)
+      for (size_t h = l; h < n; ++h)
+        r.find_range_min(l, h);
+  };
+  const auto bf_sweep = cs.run("Brute-Force", prefix_length, bf_all);
+  complexity_sweep::print(std::cout, bf_sweep);
+  std::cout << std::endl;
+
+  for (const auto *sweep : {&dc_sweep, &bf_sweep})
+    for (const auto &p : sweep->points)
+      bl.add(sweep->name + " all ranges", p.n, p.ms);
 
-  return 0;
+  return bl.finish_from_env(std::cout) ? 1 : 0;
 }
@@ -14,6 +14,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "rng.hpp"
+
 class RubiksCube {
 
 public:
@@ -331,11 +333,11 @@ std::ostream &operator<<(std::ostream &os, const RubiksCube &rc) {
 
 // Let a monkey play with the cube.
 size_t monkey_play(RubiksCube &r) {
-  srand(time(0));
-  const size_t nmoves = random() % 200;
+  xoshiro256 rng(time(0));
+  const size_t nmoves = rng.bounded(200);
   for (auto i = 0U; i < nmoves; ++i) {
     const RubiksCube::move_type_t move =
-        static_cast<RubiksCube::move_type_t>(random() % RubiksCube::NUMMOVES);
+        static_cast<RubiksCube::move_type_t>(rng.bounded(RubiksCube::NUMMOVES));
     r.apply_move(move);
   }
 
@@ -0,0 +1,276 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <ostream>
+
+// Heap traffic profiler. Including this header replaces the global
+// operator new/delete of the program with versions that count allocations,
+// bytes and live bytes. Replacement allocation functions may not be inline,
+// so the header must be included in exactly one translation unit (every
+// program in this tree is a single translation unit).
+//
+// Usage:
+//   alloc_tracker::scope as;
+//   ... code under test ...
+//   std::cout << as.get() << std::endl;
+//
+// Scopes nest and can be combined with an exec_time capture of the same
+// code. The counters are global atomics, so allocations made by other
+// threads while a scope is open are attributed to it as well.
+class alloc_tracker {
+public:
+  // Heap traffic over an interval.
+  struct stats_t {
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t bytes;
+
+    // Highest live heap size reached, relative to the start of the
+    // interval.
+    int64_t peak_live_bytes;
+
+    stats_t() : allocs(0), frees(0), bytes(0), peak_live_bytes(0) {}
+  };
+
+  // RAII interval over which heap traffic is measured.
+  class scope {
+    const uint64_t mAllocs;
+    const uint64_t mFrees;
+    const uint64_t mBytes;
+    const int64_t mLive;
+
+    // Peak of any enclosing scope, restored on exit.
+    const int64_t mOuterPeak;
+
+  public:
+    scope()
+        : mAllocs(counter(ALLOCS).load(std::memory_order_relaxed)),
+          mFrees(counter(FREES).load(std::memory_order_relaxed)),
+          mBytes(counter(BYTES).load(std::memory_order_relaxed)),
+          mLive(live().load(std::memory_order_relaxed)),
+          mOuterPeak(peak().exchange(mLive, std::memory_order_relaxed)) {}
+
+    ~scope() {
+      int64_t p = peak().load(std::memory_order_relaxed);
+      while (p < mOuterPeak &&
+             !peak().compare_exchange_weak(p, mOuterPeak,
+                                           std::memory_order_relaxed))
+        ;
+    }
+
+    scope(const scope &) = delete;
+    scope &operator=(const scope &) = delete;
+
+    // Heap traffic since the scope was opened.
+    stats_t get() const {
+      stats_t s;
+      s.allocs = counter(ALLOCS).load(std::memory_order_relaxed) - mAllocs;
+      s.frees = counter(FREES).load(std::memory_order_relaxed) - mFrees;
+      s.bytes = counter(BYTES).load(std::memory_order_relaxed) - mBytes;
+      s.peak_live_bytes = peak().load(std::memory_order_relaxed) - mLive;
+      return s;
+    }
+  };
+
+  // Allocation hooks used by the replaced operators. align is a power of
+  // two; the default keeps the max_align_t alignment of malloc.
+  static void *allocate(size_t sz, size_t align = HEADER) {
+    // Keep the size in front of the block so that delete knows how many
+    // bytes are released. The header is as large as the alignment, so
+    // that it preserves it.
+    const size_t header = header_size(align);
+    void *p = (align <= HEADER)
+                  ? std::malloc(sz + header)
+                  : std::aligned_alloc(align, (sz + 2 * header - 1) &
+                                                  ~(header - 1));
+    if (!p)
+      return nullptr;
+    std::memcpy(p, &sz, sizeof(sz));
+
+    counter(ALLOCS).fetch_add(1, std::memory_order_relaxed);
+    counter(BYTES).fetch_add(sz, std::memory_order_relaxed);
+    const int64_t l = live().fetch_add(sz, std::memory_order_relaxed) + sz;
+    int64_t p_old = peak().load(std::memory_order_relaxed);
+    while (p_old < l && !peak().compare_exchange_weak(
+                            p_old, l, std::memory_order_relaxed))
+      ;
+
+    return static_cast<char *>(p) + header;
+  }
+
+  // allocate() for the throwing operators: as the library ones do, call
+  // the new-handler until it frees enough memory, or throw bad_alloc if
+  // none is installed.
+  static void *allocate_or_throw(size_t sz, size_t align = HEADER) {
+    for (;;) {
+      void *p = allocate(sz, align);
+      if (p)
+        return p;
+      std::new_handler handler = std::get_new_handler();
+      if (!handler)
+        throw std::bad_alloc();
+      handler();
+    }
+  }
+
+  // align must be the one the block was allocated with.
+  static void deallocate(void *ptr, size_t align = HEADER) {
+    if (!ptr)
+      return;
+    // Once inlined, GCC takes ptr for the start of the array new[]
+    // returned and flags the header in front of it as out of bounds.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+    void *p = static_cast<char *>(ptr) - header_size(align);
+    size_t sz;
+    std::memcpy(&sz, p, sizeof(sz));
+#pragma GCC diagnostic pop
+    counter(FREES).fetch_add(1, std::memory_order_relaxed);
+    live().fetch_sub(sz, std::memory_order_relaxed);
+    std::free(p);
+  }
+
+private:
+  enum counter_t { ALLOCS, FREES, BYTES, NUM_COUNTERS };
+
+  static const size_t HEADER = alignof(std::max_align_t);
+
+  static size_t header_size(size_t align) {
+    return (align > HEADER) ? align : HEADER;
+  }
+
+  // Function-local statics avoid static initialization order issues with
+  // allocations made before main.
+  static std::atomic<uint64_t> &counter(counter_t c) {
+    static std::atomic<uint64_t> counters[NUM_COUNTERS];
+    return counters[c];
+  }
+
+  static std::atomic<int64_t> &live() {
+    static std::atomic<int64_t> l(0);
+    return l;
+  }
+
+  static std::atomic<int64_t> &peak() {
+    static std::atomic<int64_t> p(0);
+    return p;
+  }
+};
+
+inline std::ostream &operator<<(std::ostream &os,
+                                const alloc_tracker::stats_t &s) {
+  os << "allocs=" << s.allocs << " frees=" << s.frees << " bytes=" << s.bytes
+     << " peak_live_bytes=" << s.peak_live_bytes;
+  return os;
+}
+
+// Replaced global allocation functions, including the aligned
+// (std::align_val_t) overloads used for over-aligned types. As in the
+// library, the nothrow versions report the failure of the throwing ones
+// as nullptr.
+void *operator new(size_t sz) { return alloc_tracker::allocate_or_throw(sz); }
+
+void *operator new[](size_t sz) {
+  return alloc_tracker::allocate_or_throw(sz);
+}
+
+void *operator new(size_t sz, std::align_val_t al) {
+  return alloc_tracker::allocate_or_throw(sz, static_cast<size_t>(al));
+}
+
+void *operator new[](size_t sz, std::align_val_t al) {
+  return alloc_tracker::allocate_or_throw(sz, static_cast<size_t>(al));
+}
+
+void *operator new(size_t sz, const std::nothrow_t &) noexcept {
+  try {
+    return alloc_tracker::allocate_or_throw(sz);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void *operator new[](size_t sz, const std::nothrow_t &) noexcept {
+  try {
+    return alloc_tracker::allocate_or_throw(sz);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void *operator new(size_t sz, std::align_val_t al,
+                   const std::nothrow_t &) noexcept {
+  try {
+    return alloc_tracker::allocate_or_throw(sz, static_cast<size_t>(al));
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void *operator new[](size_t sz, std::align_val_t al,
+                     const std::nothrow_t &) noexcept {
+  try {
+    return alloc_tracker::allocate_or_throw(sz, static_cast<size_t>(al));
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *p) noexcept { alloc_tracker::deallocate(p); }
+
+void operator delete[](void *p) noexcept { alloc_tracker::deallocate(p); }
+
+void operator delete(void *p, size_t) noexcept {
+  alloc_tracker::deallocate(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+  alloc_tracker::deallocate(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  alloc_tracker::deallocate(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  alloc_tracker::deallocate(p);
+}
+
+void operator delete(void *p, std::align_val_t al) noexcept {
+  alloc_tracker::deallocate(p, static_cast<size_t>(al));
+}
+
+void operator delete[](void *p, std::align_val_t al) noexcept {
+  alloc_tracker::deallocate(p, static_cast<size_t>(al));
+}
+
+void operator delete(void *p, size_t, std::align_val_t al) noexcept {
+  alloc_tracker::deallocate(p, static_cast<size_t>(al));
+}
+
+void operator delete[](void *p, size_t, std::align_val_t al) noexcept {
+  alloc_tracker::deallocate(p, static_cast<size_t>(al));
+}
+
+void operator delete(void *p, std::align_val_t al,
+                     const std::nothrow_t &) noexcept {
+  alloc_tracker::deallocate(p, static_cast<size_t>(al));
+}
+
+void operator delete[](void *p, std::align_val_t al,
+                       const std::nothrow_t &) noexcept {
+  alloc_tracker::deallocate(p, static_cast<size_t>(al));
+}
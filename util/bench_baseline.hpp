@@ -0,0 +1,276 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "perf_counters.hpp"
+
+// Benchmark baseline store and regression comparison.
+//
+// Results (algorithm, input size, percentiles, hardware counters) are
+// collected into a bench_baseline, which can be saved to a versioned text
+// file. A later run loads the file and compares: an entry is flagged as a
+// regression when its mean time grew by more than the threshold AND the
+// difference is significant under Welch's t-test at 95%. Entries with a
+// single sample on either side (plain exec_time measurements) cannot be
+// tested and are judged on the threshold alone.
+//
+// Programs opt in through the environment, so the demos keep their
+// behavior by default:
+//   BENCH_SAVE=<file>       save the results of this run as the baseline.
+//   BENCH_COMPARE=<file>    compare the results of this run to a baseline.
+//   BENCH_THRESHOLD=<pct>   regression threshold in percent (default 5).
+class bench_baseline {
+public:
+  // Bump when the file layout changes.
+  static const int VERSION = 1;
+
+  struct entry_t {
+    std::string name;
+    uint64_t n;
+    size_t samples;
+
+    // Nanoseconds.
+    double min;
+    double median;
+    double p90;
+    double p99;
+    double mean;
+    double stddev;
+
+    perf_counters::sample_t counters;
+  };
+
+  struct comparison_t {
+    std::string name;
+    uint64_t n;
+    double base_mean;
+    double cur_mean;
+
+    // Relative change of the mean in percent; positive is slower.
+    double change_pct;
+
+    // Whether Welch's t-test could be applied, and its outcome.
+    bool testable;
+    bool significant;
+
+    bool regression;
+  };
+
+private:
+  std::vector<entry_t> mEntries;
+
+  // Names may contain spaces and commas; keep them on a line of their own.
+  static std::string header() {
+    return "# mit_006 benchmark baseline v" + std::to_string(VERSION);
+  }
+
+public:
+  const std::vector<entry_t> &entries() const { return mEntries; }
+
+  // Add a result of the statistical benchmark runner.
+  void add(const benchmark::result_t &r, uint64_t n,
+           const perf_counters::sample_t &c = perf_counters::sample_t()) {
+    mEntries.push_back(entry_t{r.name, n, r.samples, r.min, r.median, r.p90,
+                               r.p99, r.mean, r.stddev, c});
+  }
+
+  // Add all results of a benchmark runner.
+  void add(const benchmark &bm, uint64_t n) {
+    for (const auto &r : bm.results())
+      add(r, n);
+  }
+
+  // Add a single exec_time measurement (milliseconds).
+  void add(const std::string &name, uint64_t n, double ms,
+           const perf_counters::sample_t &c = perf_counters::sample_t()) {
+    const double ns = ms * 1e6;
+    mEntries.push_back(entry_t{name, n, 1, ns, ns, ns, ns, ns, 0.0, c});
+  }
+
+  const entry_t *find(const std::string &name, uint64_t n) const {
+    for (const auto &e : mEntries)
+      if (e.name == name && e.n == n)
+        return &e;
+    return nullptr;
+  }
+
+  bool save(const std::string &fname) const {
+    std::ofstream ofs(fname);
+    if (!ofs)
+      return false;
+    ofs << header() << std::endl << std::setprecision(17);
+    for (const auto &e : mEntries) {
+      ofs << e.name << std::endl
+          << e.n << " " << e.samples << " " << e.min << " " << e.median << " "
+          << e.p90 << " " << e.p99 << " " << e.mean << " " << e.stddev;
+      for (int i = 0; i < perf_counters::NUM_EVENTS; ++i)
+        ofs << " " << (e.counters.valid[i] ? 1 : 0) << " "
+            << e.counters.value[i];
+      ofs << std::endl;
+    }
+    return static_cast<bool>(ofs);
+  }
+
+  // Replaces the current entries. Fails on a missing file or a version
+  // mismatch.
+  bool load(const std::string &fname) {
+    std::ifstream ifs(fname);
+    std::string line;
+    if (!std::getline(ifs, line) || line != header())
+      return false;
+
+    std::vector<entry_t> entries;
+    std::string name;
+    while (std::getline(ifs, name) && std::getline(ifs, line)) {
+      entry_t e;
+      e.name = name;
+      std::istringstream iss(line);
+      iss >> e.n >> e.samples >> e.min >> e.median >> e.p90 >> e.p99 >>
+          e.mean >> e.stddev;
+      for (int i = 0; i < perf_counters::NUM_EVENTS; ++i)
+        iss >> e.counters.valid[i] >> e.counters.value[i];
+      if (!iss)
+        return false;
+      entries.push_back(e);
+    }
+
+    mEntries.swap(entries);
+    return true;
+  }
+
+  // Compare the entries of this (current) run against a baseline.
+  std::vector<comparison_t> compare(const bench_baseline &base,
+                                    double threshold_pct) const {
+    std::vector<comparison_t> res;
+    for (const auto &cur : mEntries) {
+      const entry_t *b = base.find(cur.name, cur.n);
+      if (!b)
+        continue;
+
+      comparison_t c;
+      c.name = cur.name;
+      c.n = cur.n;
+      c.base_mean = b->mean;
+      c.cur_mean = cur.mean;
+      c.change_pct =
+          (b->mean > 0.0) ? 100.0 * (cur.mean - b->mean) / b->mean : 0.0;
+      c.testable = (b->samples > 1 && cur.samples > 1);
+      c.significant = c.testable ? welch_significant(*b, cur) : true;
+      c.regression = c.significant && c.change_pct > threshold_pct;
+      res.push_back(c);
+    }
+    return res;
+  }
+
+  // Welch's unequal variances t-test at 95%, two-sided.
+  static bool welch_significant(const entry_t &a, const entry_t &b) {
+    const double va = a.stddev * a.stddev / a.samples;
+    const double vb = b.stddev * b.stddev / b.samples;
+    if (va + vb == 0.0)
+      return a.mean != b.mean;
+    const double t = std::fabs(a.mean - b.mean) / std::sqrt(va + vb);
+    const double dof = (va + vb) * (va + vb) /
+                       (va * va / (a.samples - 1) + vb * vb / (b.samples - 1));
+    return t > benchmark::t_critical_95(static_cast<size_t>(dof));
+  }
+
+  static void report(std::ostream &os, const std::vector<comparison_t> &cmp) {
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+    os << std::fixed << std::setprecision(1);
+    for (const auto &c : cmp) {
+      os << (c.regression ? "REGRESSION " : "           ") << c.name
+         << " (n = " << c.n << "): " << c.base_mean << " -> " << c.cur_mean
+         << " ns (" << std::showpos << c.change_pct << std::noshowpos << "%"
+         << (c.testable ? (c.significant ? ", significant" : ", noise")
+                        : ", untested")
+         << ")" << std::endl;
+    }
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+  // Save and/or compare as requested by the environment (see above).
+  // Returns the number of regressions found.
+  size_t finish_from_env(std::ostream &os) const {
+    size_t regressions = 0;
+
+    const char *cmp_file = std::getenv("BENCH_COMPARE");
+    if (cmp_file) {
+      const char *thr = std::getenv("BENCH_THRESHOLD");
+      const double threshold = thr ? std::atof(thr) : 5.0;
+      bench_baseline base;
+      if (!base.load(cmp_file)) {
+        os << "Cannot load baseline: " << cmp_file << std::endl;
+      } else {
+        const auto cmp = compare(base, threshold);
+        os << "Comparison against " << cmp_file << " (threshold "
+           << threshold << "%):" << std::endl;
+        report(os, cmp);
+        for (const auto &c : cmp)
+          regressions += c.regression ? 1 : 0;
+      }
+    }
+
+    const char *save_file = std::getenv("BENCH_SAVE");
+    if (save_file) {
+      if (save(save_file))
+        os << "Baseline saved: " << save_file << std::endl;
+      else
+        os << "Cannot save baseline: " << save_file << std::endl;
+    }
+
+    return regressions;
+  }
+};
+
+// A benchmark whose results all go to a baseline, for the programs that
+// time a few cases and then save or compare them as the environment asks:
+//   baseline_benchmark bb;
+//   bb.run("case", n, [&]() { return f(); });
+//   return bb.finish(std::cout) ? 1 : 0;
+class baseline_benchmark {
+private:
+  benchmark mBench;
+
+  bench_baseline mBaseline;
+
+public:
+  explicit baseline_benchmark(
+      const benchmark::config_t &cfg = benchmark::config_t(1, 5))
+      : mBench(cfg) {}
+
+  // Benchmark func as a case of input size n.
+  template <typename F>
+  const benchmark::result_t &run(const std::string &name, uint64_t n,
+                                 F &&func) {
+    const auto &r = mBench.run(name, std::forward<F>(func));
+    mBaseline.add(r, n);
+    return r;
+  }
+
+  // Print the results, then save and/or compare them. Returns the number
+  // of regressions found.
+  size_t finish(std::ostream &os) const {
+    mBench.print(os);
+    return mBaseline.finish_from_env(os);
+  }
+};
@@ -0,0 +1,271 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "exec_time.hpp"
+
+// Optimization barrier for benchmarked code: the value is assumed to be
+// read by an empty asm statement, so the compiler has to compute it even
+// when nothing else uses it, e.g. the result of a pure inline function.
+template <typename T> inline void do_not_optimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Statistical micro-benchmark runner built on top of exec_time.
+//
+// A single exec_time capture is too coarse for operations that take a few
+// nanoseconds. The runner therefore times a batch of calls per sample and
+// divides by the batch size. After some untimed warmup runs it collects a
+// number of samples and rejects outliers outside the Tukey fences
+// [Q1 - k * IQR, Q3 + k * IQR]. The remaining samples are summarized as
+// min/median/p90/p99/mean/stddev in nanoseconds per call.
+//
+// Any callable accepted by exec_time can be benchmarked: function pointers,
+// lambdas, functors and member function pointers (followed by the object).
+// The value a call returns goes through do_not_optimize, so that the
+// compiler cannot drop the call as unused.
+// Results are accumulated and can be printed as a table, CSV or JSON.
+class benchmark {
+public:
+  // Knobs controlling how a callable is run.
+  struct config_t {
+    // Untimed runs to warm up caches and branch predictors.
+    size_t warmup_runs;
+
+    // Number of timed samples.
+    size_t samples;
+
+    // Number of calls per timed sample.
+    size_t batch;
+
+    // Tukey fence multiplier for outlier rejection. 0 disables rejection.
+    double outlier_k;
+
+    config_t(size_t w = 3, size_t s = 31, size_t b = 1, double k = 1.5)
+        : warmup_runs(w), samples(s), batch(b), outlier_k(k) {}
+  };
+
+  // Summary of the samples of one benchmarked callable.
+  // All times are in nanoseconds per call.
+  struct result_t {
+    std::string name;
+    size_t samples;
+    size_t rejected;
+    size_t batch;
+    double min;
+    double median;
+    double p90;
+    double p99;
+    double mean;
+    double stddev;
+  };
+
+  typedef std::vector<result_t> results_t;
+
+private:
+  config_t mConfig;
+
+  results_t mResults;
+
+  // One call of func, with its result, if any, kept alive.
+  template <typename F, typename... ARGS>
+  static void invoke(F &func, ARGS &... args) {
+    if constexpr (std::is_void_v<std::invoke_result_t<F &, ARGS &...>>)
+      std::invoke(func, args...);
+    else
+      do_not_optimize(std::invoke(func, args...));
+  }
+
+public:
+  explicit benchmark(const config_t &cfg = config_t()) : mConfig(cfg) {}
+
+  const config_t &config() const { return mConfig; }
+
+  void set_config(const config_t &cfg) { mConfig = cfg; }
+
+  const results_t &results() const { return mResults; }
+
+  void clear() { mResults.clear(); }
+
+  // Benchmark a callable with the given arguments. The arguments are passed
+  // by reference on every call, so the callable must not consume them.
+  // ET selects the capture clock, e.g. run<tsc_exec_time>(...) for
+  // operations too short for std::chrono.
+  template <typename ET = exec_time, typename F, typename... ARGS>
+  const result_t &run(const std::string &name, F &&func, ARGS &&... args) {
+    for (size_t i = 0; i < mConfig.warmup_runs; ++i)
+      invoke(func, args...);
+
+    const size_t batch = std::max<size_t>(mConfig.batch, 1);
+    ET et;
+    std::vector<double> ns;
+    ns.reserve(mConfig.samples);
+    for (size_t s = 0; s < mConfig.samples; ++s) {
+      et([&]() {
+        for (size_t i = 0; i < batch; ++i)
+          invoke(func, args...);
+      });
+      // exec_time reports milliseconds.
+      ns.push_back(et.get() * 1e6 / batch);
+    }
+
+    mResults.push_back(summarize(name, ns, batch, mConfig.outlier_k));
+    return mResults.back();
+  }
+
+  // Summarize raw per-call samples (nanoseconds). Exposed so that callers
+  // timing with their own clock can reuse the statistics.
+  static result_t summarize(const std::string &name, std::vector<double> ns,
+                            size_t batch = 1, double outlier_k = 1.5) {
+    result_t r;
+    r.name = name;
+    r.batch = batch;
+    r.samples = ns.size();
+    r.rejected = 0;
+    r.min = r.median = r.p90 = r.p99 = r.mean = r.stddev = 0.0;
+    if (ns.empty())
+      return r;
+
+    std::sort(ns.begin(), ns.end());
+
+    if (outlier_k > 0.0 && ns.size() >= 4) {
+      const double q1 = percentile(ns, 25.0);
+      const double q3 = percentile(ns, 75.0);
+      const double lo = q1 - outlier_k * (q3 - q1);
+      const double hi = q3 + outlier_k * (q3 - q1);
+      auto first = std::lower_bound(ns.begin(), ns.end(), lo);
+      auto last = std::upper_bound(first, ns.end(), hi);
+      r.rejected = ns.size() - (last - first);
+      ns = std::vector<double>(first, last);
+    }
+
+    r.samples = ns.size();
+    r.min = ns.front();
+    r.median = percentile(ns, 50.0);
+    r.p90 = percentile(ns, 90.0);
+    r.p99 = percentile(ns, 99.0);
+
+    double sum = 0.0;
+    for (auto v : ns)
+      sum += v;
+    r.mean = sum / ns.size();
+
+    double sq = 0.0;
+    for (auto v : ns)
+      sq += (v - r.mean) * (v - r.mean);
+    r.stddev = (ns.size() > 1) ? std::sqrt(sq / (ns.size() - 1)) : 0.0;
+
+    return r;
+  }
+
+  // Linearly interpolated percentile (0 <= p <= 100) of sorted samples.
+  static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+      return 0.0;
+    const double rank = (p / 100.0) * (sorted.size() - 1);
+    const size_t lo = static_cast<size_t>(rank);
+    const size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (rank - lo) * (sorted[hi] - sorted[lo]);
+  }
+
+  // Two-sided 95% critical value of Student's t distribution.
+  static double t_critical_95(size_t dof) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447,
+                                   2.365,  2.306, 2.262, 2.228, 2.201, 2.179,
+                                   2.160,  2.145, 2.131, 2.120, 2.110, 2.101,
+                                   2.093,  2.086, 2.080, 2.074, 2.069, 2.064,
+                                   2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    const size_t sz = sizeof(table) / sizeof(table[0]);
+    if (dof == 0)
+      return std::numeric_limits<double>::infinity();
+    return (dof <= sz) ? table[dof - 1] : 1.960;
+  }
+
+  // Human readable table.
+  void print(std::ostream &os) const {
+    const auto flags = os.flags();
+    const auto prec = os.precision();
+    os << std::left << std::setw(32) << "name" << std::right
+       << std::setw(12) << "min(ns)" << std::setw(12) << "median"
+       << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(12)
+       << "stddev" << std::setw(10) << "samples" << std::endl;
+    for (const auto &r : mResults) {
+      os << std::left << std::setw(32) << r.name << std::right << std::fixed
+         << std::setprecision(1) << std::setw(12) << r.min << std::setw(12)
+         << r.median << std::setw(12) << r.p90 << std::setw(12) << r.p99
+         << std::setw(12) << r.stddev << std::setw(10) << r.samples
+         << std::endl;
+    }
+    os.flags(flags);
+    os.precision(prec);
+  }
+
+  // One header line followed by one line per result.
+  void write_csv(std::ostream &os) const {
+    os << "name,samples,rejected,batch,min_ns,median_ns,p90_ns,p99_ns,"
+          "mean_ns,stddev_ns"
+       << std::endl;
+    for (const auto &r : mResults) {
+      os << csv_escape(r.name) << "," << r.samples << "," << r.rejected << ","
+         << r.batch << "," << r.min << "," << r.median << "," << r.p90 << ","
+         << r.p99 << "," << r.mean << "," << r.stddev << std::endl;
+    }
+  }
+
+  // A JSON array of result objects.
+  void write_json(std::ostream &os) const {
+    os << "[" << std::endl;
+    for (size_t i = 0; i < mResults.size(); ++i) {
+      const auto &r = mResults[i];
+      os << "  {\"name\": \"" << json_escape(r.name) << "\""
+         << ", \"samples\": " << r.samples << ", \"rejected\": " << r.rejected
+         << ", \"batch\": " << r.batch << ", \"min_ns\": " << r.min
+         << ", \"median_ns\": " << r.median << ", \"p90_ns\": " << r.p90
+         << ", \"p99_ns\": " << r.p99 << ", \"mean_ns\": " << r.mean
+         << ", \"stddev_ns\": " << r.stddev << "}"
+         << ((i + 1 < mResults.size()) ? "," : "") << std::endl;
+    }
+    os << "]" << std::endl;
+  }
+
+  static std::string json_escape(const std::string &s) {
+    std::string out;
+    for (auto c : s) {
+      if (c == '"' || c == '\\')
+        out.push_back('\\');
+      out.push_back(c);
+    }
+    return out;
+  }
+
+  static std::string csv_escape(const std::string &s) {
+    if (s.find_first_of(",\"") == std::string::npos)
+      return s;
+    std::string out = "\"";
+    for (auto c : s) {
+      if (c == '"')
+        out.push_back('"');
+      out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+  }
+};
@@ -0,0 +1,49 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Size of a cache line. Override with -DCACHE_LINE_SIZE=<bytes> on targets
+// with a different line size.
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+// A standard allocator handing out memory aligned to a cache line, e.g.
+//   std::vector<T, cache_aligned_allocator<T>> v;
+// makes &v[0] start a cache line.
+template <class T> struct cache_aligned_allocator {
+  typedef T value_type;
+
+  cache_aligned_allocator() noexcept {}
+
+  template <class U>
+  cache_aligned_allocator(const cache_aligned_allocator<U> &) noexcept {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+  }
+
+  void deallocate(T *p, size_t) noexcept {
+    ::operator delete(p, std::align_val_t(CACHE_LINE_SIZE));
+  }
+
+  template <class U>
+  bool operator==(const cache_aligned_allocator<U> &) const noexcept {
+    return true;
+  }
+
+  template <class U>
+  bool operator!=(const cache_aligned_allocator<U> &) const noexcept {
+    return false;
+  }
+};
@@ -0,0 +1,171 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "exec_time.hpp"
+
+// Empirical complexity estimation.
+//
+// Runs a function over a geometric series of input sizes
+// N = n_min, n_min * factor, ... <= n_max and fits
+//   log(time) = a + k * log(N)
+// by least squares. The slope k is the measured exponent: ~1 for O(n),
+// ~2 for O(n^2), slightly above 1 for O(n log n). A 95% confidence
+// interval of k is reported from the standard error of the slope. check()
+// fails a sweep whose exponent reaches a bound, to catch an accidental
+// extra factor of n, e.g. an O(n) step in the inner loop of an O(n^2) DP.
+//
+// The input of size N is produced by a generator outside of the timed
+// region; only the function under test is timed. Each size is timed
+// 'repeats' times and the fastest run is kept, as noise only ever adds time.
+class complexity_sweep {
+public:
+  struct config_t {
+    size_t n_min;
+    size_t n_max;
+    double factor;
+    size_t repeats;
+
+    config_t(size_t lo = 1000, size_t hi = 64000, double f = 2.0,
+             size_t r = 3)
+        : n_min(lo), n_max(hi), factor(f), repeats(r) {}
+  };
+
+  struct point_t {
+    size_t n;
+    double ms;
+  };
+
+  struct result_t {
+    std::string name;
+    std::vector<point_t> points;
+
+    // Fitted exponent and its 95% confidence interval.
+    double exponent;
+    double ci_low;
+    double ci_high;
+
+    // Coefficient of determination of the fit.
+    double r2;
+
+    // Whether the confidence interval lies entirely below 'limit'.
+    bool below(double limit) const { return ci_high < limit; }
+  };
+
+private:
+  config_t mConfig;
+
+public:
+  explicit complexity_sweep(const config_t &cfg = config_t()) : mConfig(cfg) {}
+
+  // gen(n) returns the input of size n; func(input) is timed.
+  template <typename GEN, typename F>
+  result_t run(const std::string &name, GEN &&gen, F &&func) const {
+    result_t r;
+    r.name = name;
+
+    exec_time et;
+    const double factor = std::max(mConfig.factor, 1.01);
+    for (double dn = static_cast<double>(mConfig.n_min);
+         dn <= static_cast<double>(mConfig.n_max); dn *= factor) {
+      const size_t n = static_cast<size_t>(dn);
+      auto input = gen(n);
+      double best = std::numeric_limits<double>::max();
+      for (size_t i = 0; i < std::max<size_t>(mConfig.repeats, 1); ++i) {
+        et(func, input);
+        best = std::min(best, et.get());
+      }
+      r.points.push_back(point_t{n, best});
+    }
+
+    fit(r);
+    return r;
+  }
+
+  // Least squares fit of log(ms) against log(n).
+  static void fit(result_t &r) {
+    r.exponent = r.ci_low = r.ci_high = r.r2 = 0.0;
+
+    std::vector<double> xs, ys;
+    for (const auto &p : r.points) {
+      // Sub-resolution timings carry no information.
+      if (p.ms <= 0.0)
+        continue;
+      xs.push_back(std::log(static_cast<double>(p.n)));
+      ys.push_back(std::log(p.ms));
+    }
+
+    const size_t k = xs.size();
+    if (k < 2)
+      return;
+
+    double mx = 0.0, my = 0.0;
+    for (size_t i = 0; i < k; ++i) {
+      mx += xs[i];
+      my += ys[i];
+    }
+    mx /= k;
+    my /= k;
+
+    double sxx = 0.0, sxy = 0.0, syy = 0.0;
+    for (size_t i = 0; i < k; ++i) {
+      sxx += (xs[i] - mx) * (xs[i] - mx);
+      sxy += (xs[i] - mx) * (ys[i] - my);
+      syy += (ys[i] - my) * (ys[i] - my);
+    }
+    if (sxx == 0.0)
+      return;
+
+    const double slope = sxy / sxx;
+    const double ssr = std::max(syy - slope * sxy, 0.0);
+    r.exponent = slope;
+    r.r2 = (syy > 0.0) ? 1.0 - ssr / syy : 1.0;
+
+    if (k > 2) {
+      const double se = std::sqrt(ssr / (k - 2) / sxx);
+      const double t = benchmark::t_critical_95(k - 2);
+      r.ci_low = slope - t * se;
+      r.ci_high = slope + t * se;
+    } else {
+      r.ci_low = -std::numeric_limits<double>::infinity();
+      r.ci_high = std::numeric_limits<double>::infinity();
+    }
+  }
+
+  static void print(std::ostream &os, const result_t &r) {
+    os << r.name << ":" << std::endl;
+    for (const auto &p : r.points)
+      os << "  N = " << std::setw(10) << p.n << "  " << p.ms << " ms"
+         << std::endl;
+    os << "  Exponent: " << r.exponent << " (95% CI [" << r.ci_low << ", "
+       << r.ci_high << "], R^2 = " << r.r2 << ")" << std::endl;
+  }
+
+  // Print r and check it against 'limit', the exponent of the expected
+  // complexity plus a margin for noise. The fitted exponent is used rather
+  // than the confidence interval, which a single noisy size can widen past
+  // any bound. Returns false, after saying so, if the exponent reaches it.
+  static bool check(std::ostream &os, const result_t &r, double limit) {
+    print(os, r);
+    if (r.exponent < limit)
+      return true;
+    os << "  Exponent over the bound of " << limit << std::endl;
+    return false;
+  }
+};
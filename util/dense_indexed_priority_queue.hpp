@@ -0,0 +1,192 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#ifdef DEBUG_IPQ
+#include <cassert>
+#endif
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// An indexed priority queue for elements that are dense integer ids
+// (e.g. vertices 0 .. V-1), each carrying a priority of type P.
+//
+// Unlike indexed_priority_queue, which hashes whole elements to find their
+// position in the heap, the ids are kept apart from their priorities:
+//  - the heap holds only ids,
+//  - the priority of an id is stored in a vector indexed by the id,
+//  - the heap position of an id is stored in a vector indexed by the id.
+// Thus every index operation, in particular the decrease-key of a
+// Dijkstra-style relaxation, is a plain array access and never hashes.
+//
+// The template argument CMP orders the priorities and dictates whether the
+// heap is min or max. The default FANOUT of the heap is 2 (binary heap).
+// The id space grows on demand; a size hint may be given to the constructor.
+template <class P, class CMP = std::less<P>, size_t FANOUT = 2>
+class dense_indexed_priority_queue {
+
+public:
+  typedef size_t key_type;
+  typedef P priority_type;
+
+  // Position of ids that are not in the queue.
+  static constexpr size_t NOT_QUEUED = static_cast<size_t>(-1);
+
+private:
+  CMP mCmp;
+
+  // Ids in heap order.
+  std::vector<size_t> mHeap;
+
+  // Priority of an id; meaningful only while the id is queued.
+  std::vector<P> mPri;
+
+  // Heap position of an id or NOT_QUEUED.
+  std::vector<size_t> mPos;
+
+  bool higher(size_t id1, size_t id2) const {
+    return mCmp(mPri[id1], mPri[id2]);
+  }
+
+  // Move the id at heap position pos towards the root while it has a higher
+  // priority than its parent. The parents on the way are shifted down into
+  // the hole left behind; the id is written once, at its final position.
+  void sift_up(size_t pos) {
+    const size_t id = mHeap[pos];
+    while (pos > 0) {
+      const size_t par = (pos - 1) / FANOUT;
+      if (!higher(id, mHeap[par]))
+        break;
+      mHeap[pos] = mHeap[par];
+      mPos[mHeap[pos]] = pos;
+      pos = par;
+    }
+    mHeap[pos] = id;
+    mPos[id] = pos;
+  }
+
+  // Move the id at heap position pos towards the leaves while any of its
+  // children has a higher priority, shifting the highest priority child up.
+  void sift_down(size_t pos) {
+    const size_t id = mHeap[pos];
+    const size_t n = mHeap.size();
+    for (;;) {
+      const size_t first = FANOUT * pos + 1;
+      if (first >= n)
+        break;
+      const size_t last = (first + FANOUT < n) ? first + FANOUT : n;
+      size_t best = first;
+      for (size_t c = first + 1; c < last; ++c)
+        if (higher(mHeap[c], mHeap[best]))
+          best = c;
+      if (!higher(mHeap[best], id))
+        break;
+      mHeap[pos] = mHeap[best];
+      mPos[mHeap[pos]] = pos;
+      pos = best;
+    }
+    mHeap[pos] = id;
+    mPos[id] = pos;
+  }
+
+  void grow(size_t id) {
+    if (id >= mPos.size()) {
+      const size_t n = (id + 1 > 2 * mPos.size()) ? id + 1 : 2 * mPos.size();
+      mPri.resize(n);
+      mPos.resize(n, NOT_QUEUED);
+    }
+  }
+
+#ifdef DEBUG_IPQ
+  // Check the heap property at each element and that the positions are
+  // consistent with the heap.
+  void sanity_check() const {
+    for (size_t pos = 1; pos < mHeap.size(); ++pos)
+      assert(!higher(mHeap[pos], mHeap[(pos - 1) / FANOUT]));
+    size_t queued = 0;
+    for (size_t id = 0; id < mPos.size(); ++id) {
+      if (mPos[id] != NOT_QUEUED) {
+        assert(mHeap[mPos[id]] == id);
+        ++queued;
+      }
+    }
+    assert(queued == mHeap.size());
+  }
+#else
+#define sanity_check()
+#endif
+
+public:
+  // num_ids: expected id space, ids 0 .. num_ids - 1.
+  explicit dense_indexed_priority_queue(size_t num_ids = 0)
+      : mPri(num_ids), mPos(num_ids, NOT_QUEUED) {}
+
+  // Returns the id with the top priority.
+  size_t top() const { return mHeap.front(); }
+
+  const P &top_priority() const { return mPri[mHeap.front()]; }
+
+  bool empty() const { return mHeap.empty(); }
+
+  size_t size() const { return mHeap.size(); }
+
+  bool contains(size_t id) const {
+    return id < mPos.size() && mPos[id] != NOT_QUEUED;
+  }
+
+  // Priority of a queued id.
+  const P &priority(size_t id) const { return mPri[id]; }
+
+  // Priority of id if queued, not_found otherwise.
+  const P &find(size_t id, const P &not_found) const {
+    return contains(id) ? mPri[id] : not_found;
+  }
+
+  // Move the last id to the top and fix the disorder at top.
+  void pop() {
+    if (mHeap.empty())
+      return;
+
+    mPos[mHeap.front()] = NOT_QUEUED;
+    mHeap.front() = mHeap.back();
+    mHeap.pop_back();
+    if (!mHeap.empty())
+      sift_down(0);
+    sanity_check();
+  }
+
+  // Insert id with priority p, or update its priority if already queued.
+  void push(size_t id, const P &p) {
+    if (update(id, p))
+      return;
+
+    grow(id);
+    mPri[id] = p;
+    mHeap.push_back(id);
+    sift_up(mHeap.size() - 1);
+    sanity_check();
+  }
+
+  // Change the priority of a queued id and restore the heap order.
+  bool update(size_t id, const P &p) {
+    if (!contains(id))
+      return false;
+
+    const bool lowered = mCmp(mPri[id], p);
+    mPri[id] = p;
+    if (lowered)
+      sift_down(mPos[id]);
+    else
+      sift_up(mPos[id]);
+
+    sanity_check();
+    return true;
+  }
+};
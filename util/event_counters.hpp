@@ -0,0 +1,157 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+// Named event counters for hot paths, e.g. probes per lookup or rotations
+// per insert.
+//
+//   uint32_t find_index(uint32_t key) const {
+//     ...
+//     COUNT_EVENT("open_addressing.probes");
+//     ...
+//   }
+//
+// Counting is compiled in only when ENABLE_COUNTERS is defined, e.g.
+//   CXXFLAGS=-DENABLE_COUNTERS make
+// Otherwise COUNT_EVENT and COUNT_EVENT_N expand to nothing.
+//
+// Each call site resolves its counter name to a slot once (a function-local
+// static); a hit is then a single increment of a thread-local slot, with no
+// atomics or locks. The per-thread counts are merged into the totals when a
+// thread exits, and the totals are printed to stderr at program exit, so
+// counts stay exact in parallel code. Names must be string literals (or
+// otherwise outlive the program). At most MAX_EVENT_COUNTERS distinct names
+// are supported.
+
+#ifdef ENABLE_COUNTERS
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#ifndef MAX_EVENT_COUNTERS
+#define MAX_EVENT_COUNTERS 128
+#endif
+
+class event_counters {
+public:
+  // Counts of one thread.
+  struct block_t {
+    uint64_t counts[MAX_EVENT_COUNTERS];
+
+    block_t() {
+      for (auto &c : counts)
+        c = 0;
+      get_registry().attach(this);
+    }
+
+    ~block_t() { get_registry().detach(this); }
+
+    block_t(const block_t &) = delete;
+    block_t &operator=(const block_t &) = delete;
+  };
+
+  // Slot of a counter name; registers the name on first use.
+  static size_t id(const char *name) { return get_registry().id(name); }
+
+  // Counts of the calling thread.
+  static uint64_t *local() {
+    thread_local block_t b;
+    return b.counts;
+  }
+
+  // Print the totals of the exited threads plus the current counts of the
+  // live ones.
+  static void dump(std::ostream &os) { get_registry().dump(os); }
+
+private:
+  class registry {
+    std::mutex mLock;
+    std::vector<const char *> mNames;
+    uint64_t mTotals[MAX_EVENT_COUNTERS];
+    std::vector<block_t *> mLive;
+
+  public:
+    registry() {
+      for (auto &t : mTotals)
+        t = 0;
+    }
+
+    // The calling (main) thread's block is gone by now.
+    ~registry() { dump(std::cerr); }
+
+    size_t id(const char *name) {
+      std::lock_guard<std::mutex> lg(mLock);
+      for (size_t i = 0; i < mNames.size(); ++i)
+        if (std::strcmp(mNames[i], name) == 0)
+          return i;
+      if (mNames.size() == MAX_EVENT_COUNTERS) {
+        std::cerr << "event_counters: too many counters, dropping " << name
+                  << std::endl;
+        return MAX_EVENT_COUNTERS - 1;
+      }
+      mNames.push_back(name);
+      return mNames.size() - 1;
+    }
+
+    void attach(block_t *b) {
+      std::lock_guard<std::mutex> lg(mLock);
+      mLive.push_back(b);
+    }
+
+    void detach(block_t *b) {
+      std::lock_guard<std::mutex> lg(mLock);
+      for (size_t i = 0; i < MAX_EVENT_COUNTERS; ++i)
+        mTotals[i] += b->counts[i];
+      for (auto itr = mLive.begin(); itr != mLive.end(); ++itr) {
+        if (*itr == b) {
+          mLive.erase(itr);
+          break;
+        }
+      }
+    }
+
+    void dump(std::ostream &os) {
+      std::lock_guard<std::mutex> lg(mLock);
+      os << "Event counters:" << std::endl;
+      for (size_t i = 0; i < mNames.size(); ++i) {
+        uint64_t total = mTotals[i];
+        for (const auto *b : mLive)
+          total += b->counts[i];
+        os << "  " << std::left << std::setw(40) << mNames[i] << std::right
+           << std::setw(16) << total << std::endl;
+      }
+    }
+  };
+
+  static registry &get_registry() {
+    static registry r;
+    return r;
+  }
+};
+
+#define COUNT_EVENT_N(name, n)                                                 \
+  do {                                                                         \
+    static const size_t event_counter_id_ = event_counters::id(name);          \
+    event_counters::local()[event_counter_id_] += (n);                         \
+  } while (0)
+
+#else
+
+#define COUNT_EVENT_N(name, n)                                                 \
+  do {                                                                         \
+  } while (0)
+
+#endif
+
+#define COUNT_EVENT(name) COUNT_EVENT_N(name, 1)
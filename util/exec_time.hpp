@@ -7,44 +7,89 @@
 //
 
 #pragma once
-#include <chrono>
+#include <functional>
+#include <memory>
 #include <utility>
 
-// Utility to capture execution time of a function.
-class exec_time {
+#include "perf_counters.hpp"
+#include "tsc_clock.hpp"
+
+// Utility to capture execution time of a function. Optionally, hardware
+// performance counters (cycles, instructions, cache and branch misses) are
+// collected over the same interval; see perf_counters.
+// The CLOCK policy decides how time stamps are taken; see tsc_clock.hpp.
+template <class CLOCK> class basic_exec_time {
+public:
+  enum counters_t { TIME_ONLY, WITH_COUNTERS };
+
 private:
   double mDuration;
 
+  // Null when counters are not requested or not available.
+  std::unique_ptr<perf_counters> mPerf;
+
+  perf_counters::sample_t mCounters;
+
   // RAII capture execution time duration.
+  // The counters are started before the start time stamp and stopped after
+  // the end one, so that the time does not include their system calls.
   struct TimeCapture {
 
-    exec_time &mExect;
+    basic_exec_time &mExect;
 
-    typedef decltype(std::chrono::high_resolution_clock::now()) time_point_t;
+    typedef typename CLOCK::tick_t time_point_t;
     const time_point_t mTStart;
 
-    TimeCapture(exec_time &et)
-        : mExect(et), mTStart(std::chrono::high_resolution_clock::now()) {}
+    static time_point_t start(basic_exec_time &et) {
+      if (et.mPerf)
+        et.mPerf->start();
+      return CLOCK::start();
+    }
+
+    TimeCapture(basic_exec_time &et) : mExect(et), mTStart(start(et)) {}
 
     ~TimeCapture() {
-            const time_point_t tEnd = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double, std::milli> ms_double = tEnd - mTStart;
-            mExect.mDuration = ms_double.count();
+      const time_point_t tEnd = CLOCK::stop();
+      if (mExect.mPerf)
+        mExect.mCounters = mExect.mPerf->stop();
+      mExect.mDuration = CLOCK::to_ms(mTStart, tEnd);
     }
   };
 
 public:
-  exec_time() : mDuration(0.0) {}
+  // RAII capture of an arbitrary scope:
+  //   { exec_time::scope s(et); ... } std::cout << et.get();
+  typedef TimeCapture scope;
+
+  explicit basic_exec_time(counters_t c = TIME_ONLY) : mDuration(0.0) {
+    if (c == WITH_COUNTERS) {
+      mPerf.reset(new perf_counters());
+      if (!mPerf->available())
+        mPerf.reset();
+    }
+  }
 
   // Returns execution duration in milliseconds.
   double get() const { return mDuration; }
 
-  // Function operator to execute a function.
-  template <typename R, typename... ARGS>
-  constexpr auto operator()(R (*func)(ARGS...), ARGS ... args)
-      -> decltype(func(args...)) {
-              TimeCapture tc(*this);
-    return func(std::forward<ARGS>(args)...);
+  // Whether hardware counters are being collected.
+  bool has_counters() const { return mPerf != nullptr; }
+
+  // Returns the counters of the last execution. All invalid if counters
+  // were not requested or are not available.
+  const perf_counters::sample_t &counters() const { return mCounters; }
+
+  // Function operator to execute a callable: a function pointer, a lambda,
+  // a functor or a member function pointer followed by the object.
+  template <typename F, typename... ARGS>
+  constexpr decltype(auto) operator()(F &&func, ARGS &&... args) {
+    TimeCapture tc(*this);
+    return std::invoke(std::forward<F>(func), std::forward<ARGS>(args)...);
   }
 };
 
+// Portable std::chrono based capture.
+typedef basic_exec_time<chrono_clock> exec_time;
+
+// Time stamp counter based capture for nanosecond scale operations.
+typedef basic_exec_time<tsc_clock> tsc_exec_time;
@@ -11,141 +11,238 @@
 #ifdef DEBUG_IPQ
 #include <cassert>
 #endif
+#include <cstddef>
+#include <iterator>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "cache_aligned.hpp"
+
 // A priority queue of elements of type T that supports efficient (O(lg n))
 // update of priority of elements. The indexed priority queue is implemented
 // using a heap. The template argument CMP dictates whether the heap is min
-// or max. The default FANOUT of the heap is 2 (binary heap). Other fanout
-// values may be used if required. The elements to index mapping is maintained
-// using a hash map.
+// or max. The default FANOUT of the heap is 4: a 4-ary heap is shallower
+// than a binary one and beat it on both graphs of bench_ipq_fanout at -O2.
+// Other fanout values may be used if required. The elements to index
+// mapping is maintained using a hash map.
+//
+// push returns a handle to the element. A handle stays valid, and keeps
+// referring to the same element, until the queue is cleared; contains tells
+// whether its element is still queued. priority and decrease_key take a
+// handle and never touch the hash map, so callers that keep the handles
+// (e.g. one per vertex) update priorities without re-hashing the elements.
+// For (key, priority) pairs, decrease_key also takes just the priority and
+// does not copy the key either.
+// Inside the heap elements are moved, while the hash map only ever sees
+// inserts and erases of whole elements.
+//
+// So that a handle never comes to refer to another element, handles are
+// not reused: every push of a new element takes a fresh one, and the
+// handle table grows by a word per push until the queue is cleared. A
+// long-lived queue whose callers do not keep handles (e.g. a work queue)
+// should be cleared when it runs empty.
+//
+// The sift routines are iterative: the element being placed is lifted out,
+// a "hole" travels up or down the heap while the elements on the way are
+// moved into it, and the element is written once at its final position.
+//
+// The heap vector is cache-line aligned and starts with FANOUT - 1 unused
+// slots, which puts the first child of every node at a multiple of FANOUT.
+// Thus the FANOUT children of a node, all of which are compared on the way
+// down, lie at a multiple of FANOUT * sizeof(T) bytes from the start of a
+// cache line. They share one line when FANOUT * sizeof(T) divides the
+// line size (e.g. FANOUT 8 with 8-byte elements). Otherwise, e.g. with
+// 40-byte elements, groups of children straddle line boundaries, and the
+// layout only saves the index arithmetic. T must be default constructible
+// to fill the unused slots.
+//
+// Many elements are best added at once: the range constructor and
+// push_batch/update_batch write all the elements first and then restore
+// the heap order once, bottom-up (Floyd's heap construction, O(n)), when
+// that is cheaper than sifting each element on its own.
 template <class T, class CMP = std::less<T>, class HASH = std::hash<T>,
-          class PRED = std::equal_to<T>, size_t FANOUT = 2>
+          class PRED = std::equal_to<T>, size_t FANOUT = 4>
 class indexed_priority_queue {
 
+public:
+  typedef size_t handle_t;
+
+  // Position of handles whose element is not in the queue.
+  static constexpr size_t NOT_QUEUED = static_cast<size_t>(-1);
+
 private:
+  // Unused slots at the front of the heap vector.
+  static constexpr size_t PAD = FANOUT - 1;
+
   // Comparator: Should implement a function operator that takes two
   // elements of type T as argument and return a boolean result.
   CMP mCmp;
 
-  // The heap is stored in a vector.
-  typedef std::vector<T> HeapStoreT;
+  // The heap is stored in a cache-line aligned vector; heap position pos is
+  // at index PAD + pos.
+  typedef std::vector<T, cache_aligned_allocator<T>> HeapStoreT;
   HeapStoreT mHeapStore;
 
-  // Hash-map of element to index.
-  typedef std::unordered_map<T, size_t, HASH, PRED> IndexT;
+  // Handle of the element at each heap position.
+  std::vector<handle_t> mHeapHandles;
+
+  // Heap position of the element of each handle or NOT_QUEUED.
+  std::vector<size_t> mPos;
+
+  // Hash-map of element to handle.
+  typedef std::unordered_map<T, handle_t, HASH, PRED> IndexT;
   IndexT mIndex;
 
 private:
-  // Utility function to find the parent of an element.
-  template <typename HS, typename HSITR>
-  static HSITR get_parent_itr(HS &hs, HSITR itr) {
-    if (hs.empty() || itr == hs.begin() || itr == hs.end())
-      return hs.end();
-
-    const auto idx = itr - hs.begin();
-    const auto par_idx = (idx - 1) / FANOUT;
+  // Element at a heap position.
+  T &at(size_t pos) { return mHeapStore[PAD + pos]; }
+  const T &at(size_t pos) const { return mHeapStore[PAD + pos]; }
+
+  // Heap position of the parent and of the first child of a position.
+  static size_t parent(size_t pos) { return (pos - 1) / FANOUT; }
+  static size_t first_child(size_t pos) { return FANOUT * pos + 1; }
+
+  // Move the element at position 'from' into the hole at position 'to'.
+  void move_into(size_t to, size_t from) {
+    at(to) = std::move(at(from));
+    mHeapHandles[to] = mHeapHandles[from];
+    mPos[mHeapHandles[to]] = to;
+  }
 
-    return hs.begin() + par_idx;
+  // Place an element (and its handle) into the hole at position pos.
+  void fill_hole(size_t pos, T &&elem, handle_t h) {
+    at(pos) = std::move(elem);
+    mHeapHandles[pos] = h;
+    mPos[h] = pos;
   }
 
-  // Utility function to find a child of an element.
-  template <typename HS, typename HSITR>
-  static HSITR get_child_itr(HS &hs, HSITR itr, size_t child_num) {
-    if (hs.empty() || child_num >= FANOUT)
-      return hs.end();
+  // Fix disorder at position pos if the priority of the element there is
+  // lower than any of its children. The highest priority child is moved up
+  // into the hole until the element fits.
+  void heapify_down(size_t pos) {
+    const size_t n = size();
+    if (pos >= n)
+      return;
 
-    const auto idx = itr - hs.begin();
-    const auto ch_idx = FANOUT * idx + 1 + child_num;
+    T elem(std::move(at(pos)));
+    const handle_t h = mHeapHandles[pos];
+
+    for (;;) {
+      const size_t first = first_child(pos);
+      if (first >= n)
+        break;
+      const size_t last = (first + FANOUT < n) ? first + FANOUT : n;
+
+      // The child with higher priority as per the comparison function.
+      size_t pri_child = first;
+      for (size_t c = first + 1; c < last; ++c)
+        if (mCmp(at(c), at(pri_child)))
+          pri_child = c;
+
+      if (!mCmp(at(pri_child), elem))
+        break;
+      move_into(pos, pri_child);
+      pos = pri_child;
+    }
 
-    return (ch_idx < hs.size()) ? hs.begin() + ch_idx : hs.end();
+    fill_hole(pos, std::move(elem), h);
   }
 
-  // Returns iterator to the child with higher priority as per
-  // the comparison function.
-  typename HeapStoreT::iterator
-  get_pri_child_itr(typename HeapStoreT::iterator itr) {
-    auto pri_child_itr = mHeapStore.end();
+  // Fix disorder at position pos if the priority of the element there is
+  // higher than its parent. The parents are moved down into the hole until
+  // the element fits.
+  void heapify_up(size_t pos) {
+    if (pos >= size())
+      return;
 
-    for (size_t child_num = 0; child_num < FANOUT; ++child_num) {
-      auto child_itr = get_child_itr(mHeapStore, itr, child_num);
-      if ((child_itr != mHeapStore.end()) &&
-          (pri_child_itr == mHeapStore.end() ||
-           mCmp(*child_itr, *pri_child_itr))) {
-        pri_child_itr = child_itr;
-      }
-    }
+    T elem(std::move(at(pos)));
+    const handle_t h = mHeapHandles[pos];
 
-    return pri_child_itr;
-  }
+    while (pos > 0 && mCmp(elem, at(parent(pos)))) {
+      move_into(pos, parent(pos));
+      pos = parent(pos);
+    }
 
-  // Swap the element in the two argument iteratot positions.
-  // Also update the index map accordingly.
-  void element_swap(typename HeapStoreT::iterator itr1,
-                    typename HeapStoreT::iterator itr2) {
-    std::swap(mIndex[*itr1], mIndex[*itr2]);
-    std::swap(*itr1, *itr2);
+    fill_hole(pos, std::move(elem), h);
   }
 
-  // Fix disorder at iterator itr if the priority of the element
-  // at itr is lower than any of its children by swaping the
-  // element with the highest priority child. Recursively
-  // fix any disorder at the highest priority child index after swap.
-  void heapify_down(typename HeapStoreT::iterator itr) {
-    if (itr == mHeapStore.end())
-      return;
+  // Replace the element at heap position pos with 'to' and fix the
+  // disorder.
+  void update_at(size_t pos, const T &to) {
+    const bool lowered = mCmp(at(pos), to);
+    at(pos) = to;
 
-    auto citr = get_pri_child_itr(itr);
+    if (lowered)
+      heapify_down(pos);
+    else
+      heapify_up(pos);
+  }
 
-    if (citr != mHeapStore.end() && !mCmp(*itr, *citr)) {
-      element_swap(itr, citr);
-      heapify_down(citr);
+  // Append an element without restoring the heap order. If the element is
+  // already queued, overwrite it in place instead. Returns its handle.
+  handle_t append(const T &elem) {
+    auto itr = mIndex.find(elem);
+    if (itr != mIndex.end()) {
+      at(mPos[itr->second]) = elem;
+      return itr->second;
     }
+
+    const handle_t h = mPos.size();
+    mPos.push_back(size());
+    mHeapStore.push_back(elem);
+    mHeapHandles.push_back(h);
+    mIndex.emplace(elem, h);
+    return h;
   }
 
-  // Fix disorder at iterator itr if the priority of the element
-  // at itr is higher than its parent by swapping the element with the parent.
-  // Recursively fix any disorder at the parent after swap.
-  void heapify_up(typename HeapStoreT::iterator itr) {
-    if (itr == mHeapStore.end())
+  // Restore the heap order of the whole heap: sift down every element that
+  // has children, from the last one to the root. Each subtree is a heap by
+  // the time its root is sifted. O(n).
+  void build_heap() {
+    if (size() < 2)
       return;
+    for (size_t pos = parent(size() - 1) + 1; pos-- > 0;)
+      heapify_down(pos);
+  }
 
-    auto pitr = get_parent_itr(mHeapStore, itr);
-
-    if (pitr != mHeapStore.end() && mCmp(*itr, *pitr)) {
-      element_swap(itr, pitr);
-      heapify_up(pitr);
-    }
+  // Whether build_heap over n elements is cheaper than k separate sifts of
+  // up to lg(n) levels each.
+  static bool rebuild_cheaper(size_t k, size_t n) {
+    if (FANOUT < 2)
+      return k > 0;
+    size_t levels = 1;
+    for (size_t m = n; m > FANOUT; m /= FANOUT)
+      ++levels;
+    return k * levels >= n;
   }
 
 #ifdef DEBUG_IPQ
   // Sanity checking utilities. Called after making modifications to
   // the internal data-structures (e.g. through push, pop and update).
 
-  // Recursively check that the heap property is maintained at each element.
-  void heap_sanity_check(typename HeapStoreT::const_iterator itr) const {
-    for (size_t child_num = 0; child_num < FANOUT; ++child_num) {
-      auto child_itr = get_child_itr(mHeapStore, itr, child_num);
-      if (child_itr != mHeapStore.end()) {
-        assert(!mCmp(*child_itr, *itr));
-        heap_sanity_check(child_itr);
-      }
-    }
+  // Check that the heap property is maintained at each element.
+  void heap_sanity_check() const {
+    for (size_t pos = 1; pos < size(); ++pos)
+      assert(!mCmp(at(pos), at(parent(pos))));
   }
 
-  // Check that the index map is consistent with the heap.
+  // Check that the index map and the handles are consistent with the heap.
   void index_sanity_check() const {
-    assert(mIndex.size() == mHeapStore.size());
+    assert(mIndex.size() == size());
+    assert(mHeapHandles.size() == size());
     for (const auto &i : mIndex) {
-      assert(i.second < mHeapStore.size());
-      assert(i.first == *(mHeapStore.begin() + i.second));
+      assert(i.second < mPos.size());
+      const auto pos = mPos[i.second];
+      assert(pos < size());
+      assert(mHeapHandles[pos] == i.second);
+      assert(mIndex.key_eq()(i.first, at(pos)));
     }
   }
 
   // Called after modifying the internal data-structures.
   void sanity_check() {
-    heap_sanity_check(mHeapStore.begin());
+    heap_sanity_check();
     index_sanity_check();
   }
 #else
@@ -153,66 +250,200 @@ private:
 #endif
 
 public:
+  indexed_priority_queue() : mHeapStore(PAD) {}
+
+  // Bulk construction from a range of elements in O(n); see build.
+  template <class ITR>
+  indexed_priority_queue(ITR first, ITR last) : mHeapStore(PAD) {
+    build(first, last);
+  }
+
+  // Replace the contents with a range of elements in O(n). Invalidates all
+  // handles. Returns the handles of the elements in the order of the
+  // range; a repeated element replaces the earlier one and keeps its
+  // handle.
+  template <class ITR>
+  std::vector<handle_t> build(ITR first, ITR last) {
+    clear();
+    std::vector<handle_t> handles;
+    const size_t n = std::distance(first, last);
+    handles.reserve(n);
+    mHeapStore.reserve(PAD + n);
+    for (; first != last; ++first)
+      handles.push_back(append(*first));
+    build_heap();
+    sanity_check();
+    return handles;
+  }
+
   // Returns the top-priority element.
-  const T &top() const { return *(mHeapStore.begin()); }
+  const T &top() const { return at(0); }
+
+  bool empty() const { return mHeapHandles.empty(); }
 
-  bool empty() const { return mHeapStore.empty(); }
+  size_t size() const { return mHeapHandles.size(); }
 
-  size_t size() const { return mHeapStore.size(); }
+  // Remove all elements. Invalidates all handles.
+  void clear() {
+    mHeapStore.resize(PAD);
+    mHeapHandles.clear();
+    mPos.clear();
+    mIndex.clear();
+  }
 
-  // Swap the top element with the last elemet.
-  // Erase the last element. Fix the disorder at top.
+  // Move the last element to the top. Fix the disorder at top.
   void pop() {
-    if (mHeapStore.empty())
+    if (empty())
       return;
 
-    auto fitr = mHeapStore.begin();
-    auto litr = mHeapStore.begin() + (mHeapStore.size() - 1);
-    element_swap(fitr, litr);
-    mIndex.erase(*litr);
-    mHeapStore.erase(litr);
-    heapify_down(mHeapStore.begin());
+    mPos[mHeapHandles.front()] = NOT_QUEUED;
+    mIndex.erase(at(0));
+    if (size() > 1)
+      move_into(0, size() - 1);
+    mHeapStore.pop_back();
+    mHeapHandles.pop_back();
+    heapify_down(0);
     sanity_check();
   }
 
-  // Append the argument element at the end of the heap. Recursively check if it
-  // violates the heap property at parent. Swap with the element with its parent
-  // if it does.
-  void push(const T &elem) {
+  // Append the argument element at the end of the heap and move it up while
+  // it violates the heap property at parent. If the element is already
+  // queued, update it instead. Returns the handle of the element, a new
+  // one for a new element: the handle table grows until clear().
+  handle_t push(const T &elem) {
     auto itr = mIndex.find(elem);
     if (itr != mIndex.end()) {
-      update(itr->first, elem);
-    } else {
-      mHeapStore.push_back(elem);
-      mIndex[elem] = mHeapStore.size() - 1;
-      heapify_up(mHeapStore.begin() + (mHeapStore.size() - 1));
+      const auto h = itr->second;
+      update_at(mPos[h], elem);
+      sanity_check();
+      return h;
     }
+
+    const handle_t h = mPos.size();
+    mPos.push_back(size());
+    mHeapStore.push_back(elem);
+    mHeapHandles.push_back(h);
+    mIndex.emplace(elem, h);
+    heapify_up(size() - 1);
+    sanity_check();
+    return h;
+  }
+
+  // push a range of elements. Large batches are appended as they are and
+  // ordered by a single build_heap. Returns the handles of the elements in
+  // the order of the range.
+  template <class ITR>
+  std::vector<handle_t> push_batch(ITR first, ITR last) {
+    std::vector<handle_t> handles;
+    const size_t k = std::distance(first, last);
+    handles.reserve(k);
+
+    if (!rebuild_cheaper(k, size() + k)) {
+      for (; first != last; ++first)
+        handles.push_back(push(*first));
+      return handles;
+    }
+
+    for (; first != last; ++first)
+      handles.push_back(append(*first));
+    build_heap();
     sanity_check();
+    return handles;
   }
 
-  // Update the element 'from' with 'to'. Recursively go up or down fixing
-  // heap property violations.
+  // Apply a range of (handle, element) changes to queued handles, e.g. the
+  // relaxations of all the edges of a vertex. As with decrease_key, each
+  // element must keep the key (as per PRED) of the element it replaces;
+  // its priority may move either way. Large batches are ordered by a single
+  // build_heap. Does not hash.
+  template <class ITR> void update_batch(ITR first, ITR last) {
+    const size_t k = std::distance(first, last);
+    const bool rebuild = rebuild_cheaper(k, size());
+
+    for (; first != last; ++first) {
+      const auto pos = mPos[first->first];
+#ifdef DEBUG_IPQ
+      assert(mIndex.key_eq()(at(pos), first->second));
+#endif
+      if (rebuild)
+        at(pos) = first->second;
+      else
+        update_at(pos, first->second);
+    }
+
+    if (rebuild)
+      build_heap();
+    sanity_check();
+  }
+
+  // Update the element 'from' with 'to'. Go up or down fixing heap property
+  // violations.
   bool update(const T &from, const T &to) {
     auto itr = mIndex.find(from);
     if (itr == mIndex.end())
       return false;
 
-    auto idx = itr->second;
-    mHeapStore[idx] = to;
-    mIndex.erase(from);
-    mIndex[to] = idx;
-
-    if (mCmp(from, to))
-      heapify_down(mHeapStore.begin() + idx);
-    else
-      heapify_up(mHeapStore.begin() + idx);
+    const auto h = itr->second;
+    // The hash map needs to change only if the key does.
+    if (!mIndex.key_eq()(from, to)) {
+      mIndex.erase(itr);
+      mIndex.emplace(to, h);
+    }
+    update_at(mPos[h], to);
 
     sanity_check();
     return true;
   }
 
+  // The queued element of the same key (as per PRED) as elem, or
+  // not_found.
   const T &find(const T &elem, const T &not_found) const {
+    const T *queued = find(elem);
+    return queued ? *queued : not_found;
+  }
+
+  // The queued element of the same key (as per PRED) as elem, or nullptr.
+  // The pointer is valid until the queue is modified.
+  const T *find(const T &elem) const {
     auto itr = mIndex.find(elem);
-    return (itr == mIndex.end()) ? not_found : itr->first;
+    return (itr == mIndex.end()) ? nullptr : &at(mPos[itr->second]);
+  }
+
+  // Whether the element of a handle is still queued.
+  bool contains(handle_t h) const {
+    return h < mPos.size() && mPos[h] != NOT_QUEUED;
+  }
+
+  // The element (and so the priority) of a queued handle.
+  const T &priority(handle_t h) const { return at(mPos[h]); }
+
+  // Raise the priority of the element of a queued handle to that of 'to'.
+  // 'to' must have the same key (as per PRED) as the element it replaces and
+  // must not have a lower priority. Does not hash.
+  void decrease_key(handle_t h, T to) {
+    const auto pos = mPos[h];
+#ifdef DEBUG_IPQ
+    assert(mIndex.key_eq()(at(pos), to));
+    assert(!mCmp(at(pos), to));
+#endif
+    at(pos) = std::move(to);
+    heapify_up(pos);
+    sanity_check();
+  }
+
+  // decrease_key for elements that are (key, priority) pairs, e.g. (vertex,
+  // cost): only the new priority p is given and it is written in place, so
+  // the key is neither copied nor hashed.
+  template <class U = T>
+  void decrease_key(handle_t h, const typename U::second_type &p) {
+    const auto pos = mPos[h];
+#ifdef DEBUG_IPQ
+    T to(at(pos));
+    to.second = p;
+    assert(!mCmp(at(pos), to));
+#endif
+    at(pos).second = p;
+    heapify_up(pos);
+    sanity_check();
   }
 };
@@ -0,0 +1,92 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "rng.hpp"
+
+// Undirected weighted graph with vertices 0 .. V-1 using adjacency lists,
+// shared by the programs that compare shortest path algorithms or the
+// priority queues under them. The algorithms take the graph as a const
+// reference and walk it through neighbors().
+class int_graph {
+
+public:
+  // Vertices are indices to the adjacency list.
+  typedef size_t vertex_t;
+
+  // A pair binding a vertex to a cost.
+  typedef std::pair<vertex_t, int> vertex_cost_t;
+
+  // Comparison functor to compare costs of two vertex_cost_t's.
+  struct vertex_cost_cmp {
+    bool operator()(const vertex_cost_t &lhs, const vertex_cost_t &rhs) const {
+      return lhs.second < rhs.second;
+    }
+  };
+
+  // Hash functor for vertex_cost_t. Only the vertex_t (first) component is
+  // used as a key.
+  struct vertex_cost_key_hash {
+    size_t operator()(const vertex_cost_t &vc) const {
+      return std::hash<vertex_t>{}(vc.first);
+    }
+  };
+
+  // Equality functor for vertex_cost_t. Only the vertex_t (first) component is
+  // used as a key.
+  struct vertex_cost_key_equal {
+    bool operator()(const vertex_cost_t &lhs, const vertex_cost_t &rhs) const {
+      return lhs.first == rhs.first;
+    }
+  };
+
+  typedef std::vector<vertex_cost_t> neighbors_t;
+
+  typedef std::vector<neighbors_t> adj_list_t;
+
+  enum { INFINITE = 0x7FFFFFFF };
+
+private:
+  // The adjacency list.
+  adj_list_t mAdjList;
+
+public:
+  explicit int_graph(size_t num_vertices) : mAdjList(num_vertices) {}
+
+  // A random graph with num_edges edges of costs 1 .. max_cost. The same
+  // rng state gives the same graph.
+  int_graph(size_t num_vertices, size_t num_edges, xoshiro256 &rng,
+            int max_cost = 1000)
+      : mAdjList(num_vertices) {
+    for (size_t i = 0; i < num_edges; ++i) {
+      const vertex_t u = rng.bounded(num_vertices);
+      const vertex_t v = rng.bounded(num_vertices);
+      add_edge(u, v, static_cast<int>(rng.uniform(1, max_cost)));
+    }
+  }
+
+  size_t num_vertices() const { return mAdjList.size(); }
+
+  // Adds an undirected edge to the graph.
+  void add_edge(vertex_t u, vertex_t v, int cost) {
+    if (u >= mAdjList.size() || v >= mAdjList.size())
+      return;
+
+    mAdjList[u].push_back(std::make_pair(v, cost));
+    mAdjList[v].push_back(std::make_pair(u, cost));
+  }
+
+  // The edges out of u, as (neighbor, cost) pairs.
+  const neighbors_t &neighbors(vertex_t u) const { return mAdjList[u]; }
+};
@@ -0,0 +1,164 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "exec_time.hpp"
+
+// HDR-style latency histogram.
+//
+// Values (nanoseconds) are kept in log-linear buckets: every power of two
+// range [2^k, 2^(k+1)) is split into SUB_BUCKETS / 2 equal sub-buckets, so
+// the relative error of a reported value is below 2 / SUB_BUCKETS (~6%)
+// over the whole uint64_t range, at a fixed footprint of ~8KB. Recording is
+// a couple of shifts and an increment.
+//
+// measure() times a single operation with tsc_exec_time and records it;
+// the timing overhead is a few nanoseconds on x86 and is subtracted by the
+// clock calibration. Tail latencies (e.g. a rehash hidden among a million
+// cheap inserts) show up in the high percentiles.
+class latency_histogram {
+public:
+  // Sub-buckets per power of two (must be a power of two).
+  enum { SUB_BITS = 5, SUB_BUCKETS = 1 << SUB_BITS };
+
+private:
+  enum {
+    HALF = SUB_BUCKETS / 2,
+    NUM_BUCKETS = (64 - SUB_BITS + 1) * HALF + HALF
+  };
+
+  std::string mName;
+
+  uint64_t mCounts[NUM_BUCKETS];
+
+  uint64_t mTotal;
+
+  uint64_t mMin;
+
+  uint64_t mMax;
+
+  double mSum;
+
+  tsc_exec_time mEt;
+
+  // Records the latency of the enclosing exec_time capture on destruction.
+  struct recorder {
+    latency_histogram &mHist;
+
+    explicit recorder(latency_histogram &h) : mHist(h) {}
+
+    ~recorder() { mHist.record(static_cast<uint64_t>(mHist.mEt.get() * 1e6)); }
+  };
+
+  // Index of the most significant set bit of v > 0.
+  static unsigned msb(uint64_t v) { return 63 - __builtin_clzll(v); }
+
+  static size_t bucket_of(uint64_t v) {
+    if (v < SUB_BUCKETS)
+      return v;
+    const unsigned shift = msb(v) - (SUB_BITS - 1);
+    return (shift * HALF) + (v >> shift);
+  }
+
+  // Lowest value that maps to bucket idx.
+  static uint64_t bucket_low(size_t idx) {
+    if (idx < SUB_BUCKETS)
+      return idx;
+    const unsigned shift = idx / HALF - 1;
+    return static_cast<uint64_t>(idx - shift * HALF) << shift;
+  }
+
+  // Highest value that maps to bucket idx.
+  static uint64_t bucket_high(size_t idx) {
+    return (idx + 1 < NUM_BUCKETS) ? bucket_low(idx + 1) - 1 : UINT64_MAX;
+  }
+
+public:
+  explicit latency_histogram(const std::string &name = "") : mName(name) {
+    reset();
+  }
+
+  const std::string &name() const { return mName; }
+
+  void reset() {
+    std::fill(mCounts, mCounts + NUM_BUCKETS, 0);
+    mTotal = 0;
+    mMin = UINT64_MAX;
+    mMax = 0;
+    mSum = 0.0;
+  }
+
+  // Record one latency in nanoseconds.
+  void record(uint64_t ns) {
+    ++mCounts[bucket_of(ns)];
+    ++mTotal;
+    mMin = std::min(mMin, ns);
+    mMax = std::max(mMax, ns);
+    mSum += ns;
+  }
+
+  // Time one call of a callable, record its latency and return its result.
+  template <typename F, typename... ARGS>
+  decltype(auto) measure(F &&func, ARGS &&... args) {
+    recorder r(*this);
+    return mEt(std::forward<F>(func), std::forward<ARGS>(args)...);
+  }
+
+  // Add the counts of another histogram.
+  void merge(const latency_histogram &other) {
+    for (size_t i = 0; i < NUM_BUCKETS; ++i)
+      mCounts[i] += other.mCounts[i];
+    mTotal += other.mTotal;
+    mMin = std::min(mMin, other.mMin);
+    mMax = std::max(mMax, other.mMax);
+    mSum += other.mSum;
+  }
+
+  uint64_t count() const { return mTotal; }
+
+  double mean() const { return mTotal ? mSum / mTotal : 0.0; }
+
+  // Value at percentile p (0 <= p <= 100): the upper bound of the bucket
+  // holding the p-th percentile sample, clamped to the observed range.
+  uint64_t percentile(double p) const {
+    if (mTotal == 0)
+      return 0;
+    const double rank = std::max(1.0, (p / 100.0) * mTotal);
+    uint64_t cum = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      cum += mCounts[i];
+      if (cum >= rank)
+        return std::max(mMin, std::min(mMax, bucket_high(i)));
+    }
+    return mMax;
+  }
+
+  // One line per percentile.
+  void print(std::ostream &os) const {
+    static const double pcts[] = {50.0, 90.0, 99.0, 99.9, 99.99, 100.0};
+    os << mName << ": count = " << mTotal << ", mean = " << mean()
+       << " ns, min = " << (mTotal ? mMin : 0) << " ns" << std::endl;
+    for (auto p : pcts) {
+      os << "  p" << std::left << std::setw(8) << p << std::right
+         << std::setw(12) << percentile(p) << " ns" << std::endl;
+    }
+  }
+};
+
+inline std::ostream &operator<<(std::ostream &os, const latency_histogram &h) {
+  h.print(os);
+  return os;
+}
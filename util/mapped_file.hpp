@@ -0,0 +1,99 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A file mapped read-only into memory.
+//
+// The pages of the file are read in by the kernel when they are first
+// touched, so an algorithm that looks at a few places of a huge file only
+// pays for those. The expected access pattern tunes the read-ahead:
+// RANDOM stops the kernel from reading in the neighbors of every touched
+// page, SEQUENTIAL makes it read further ahead.
+//
+//   mapped_file mf;
+//   if (!mf.open(fname, mapped_file::SEQUENTIAL))
+//     ... // Cannot open, stat or map the file.
+//   scan(mf.data(), mf.size());
+//
+// An empty file opens fine, with a null data().
+class mapped_file {
+public:
+  enum access_t { NORMAL, SEQUENTIAL, RANDOM };
+
+private:
+  const char *mData;
+  size_t mSize;
+  bool mOpen;
+
+public:
+  mapped_file() : mData(nullptr), mSize(0), mOpen(false) {}
+
+  ~mapped_file() { close(); }
+
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  // Map the whole file; false if it cannot be opened, stat-ed or mapped.
+  bool open(const std::string &fname, access_t access = NORMAL) {
+    close();
+
+    const int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+    }
+
+    // The mapping keeps the file referenced; the descriptor is not needed.
+    void *p = nullptr;
+    if (st.st_size > 0) {
+      p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        return false;
+      }
+      const int advice = (access == RANDOM)       ? MADV_RANDOM
+                         : (access == SEQUENTIAL) ? MADV_SEQUENTIAL
+                                                  : MADV_NORMAL;
+      // Only a hint.
+      ::madvise(p, st.st_size, advice);
+    }
+    ::close(fd);
+
+    mData = static_cast<const char *>(p);
+    mSize = st.st_size;
+    mOpen = true;
+    return true;
+  }
+
+  void close() {
+    if (mData)
+      ::munmap(const_cast<char *>(mData), mSize);
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+  }
+
+  bool is_open() const { return mOpen; }
+
+  const char *data() const { return mData; }
+
+  size_t size() const { return mSize; }
+};
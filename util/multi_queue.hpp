@@ -0,0 +1,175 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+#include "cache_aligned.hpp"
+#include "indexed_priority_queue.hpp"
+#include "rng.hpp"
+
+// A MultiQueue (Rihani, Sanders and Dementiev): a relaxed min priority
+// queue of elements of type T that many threads push to and pop from
+// without a global lock.
+//
+// It is made of num_threads * queues_per_thread sequential heaps
+// (indexed_priority_queue), each behind its own lock. push locks a random
+// heap. pop samples two random heaps, peeks at their cached top priorities
+// without locking and pops from the better one. A thread that finds a heap
+// locked simply samples again, so threads never wait on each other.
+//
+// pop does not necessarily return the minimum: the rank of the popped
+// element among all queued elements is O(num_threads * queues_per_thread)
+// in expectation. queues_per_thread trades that rank error for contention;
+// more heaps per thread mean fewer collisions and worse elements. Parallel
+// Dijkstra tolerates the relaxation by skipping stale elements
+// (label-correcting), at the cost of some wasted pops.
+//
+// As with radix_heap, the functor KEY maps an element to its priority, an
+// unsigned integer of up to 64 bits, lower first; it is what the heaps
+// publish as their top priority. Within one heap elements are indexed by
+// HASH/PRED, so an element pushed into a heap that holds one of the same
+// key merges with it, keeping the higher priority; elements with equal
+// keys may still coexist in different heaps.
+template <class T, class KEY, class HASH = std::hash<T>,
+          class PRED = std::equal_to<T>>
+class multi_queue {
+
+public:
+  typedef uint64_t priority_t;
+
+private:
+  // Top priority published by an empty heap.
+  static constexpr priority_t EMPTY = std::numeric_limits<priority_t>::max();
+
+  struct key_cmp {
+    KEY key;
+    bool operator()(const T &lhs, const T &rhs) const {
+      return key(lhs) < key(rhs);
+    }
+  };
+
+  typedef indexed_priority_queue<T, key_cmp, HASH, PRED, 4> heap_t;
+
+  // One heap per cache line, so that threads working on different heaps do
+  // not share lines.
+  struct alignas(CACHE_LINE_SIZE) queue_t {
+    std::mutex lock;
+    // Priority of the top element or EMPTY; written under the lock, read
+    // without it.
+    std::atomic<priority_t> top;
+    heap_t heap;
+
+    queue_t() : top(EMPTY) {}
+
+    void publish_top(const KEY &key) {
+      top.store(heap.empty() ? EMPTY : key(heap.top()),
+                std::memory_order_relaxed);
+    }
+  };
+
+  KEY mKey;
+
+  const size_t mNumQueues;
+  std::unique_ptr<queue_t[]> mQueues;
+
+  // Random number generator of the calling thread.
+  static xoshiro256 &local_rng() {
+    static std::atomic<uint64_t> next_seed(1);
+    thread_local xoshiro256 rng(next_seed.fetch_add(1));
+    return rng;
+  }
+
+  size_t random_queue() {
+    return local_rng().bounded(static_cast<uint32_t>(mNumQueues));
+  }
+
+public:
+  explicit multi_queue(size_t num_threads, size_t queues_per_thread = 2)
+      : mNumQueues(std::max<size_t>(num_threads * queues_per_thread, 1)),
+        mQueues(new queue_t[mNumQueues]) {}
+
+  multi_queue(const multi_queue &) = delete;
+  multi_queue &operator=(const multi_queue &) = delete;
+
+  size_t num_queues() const { return mNumQueues; }
+
+  // Whether all the heaps are empty. Only a snapshot while other threads
+  // push.
+  bool empty() const {
+    for (size_t i = 0; i < mNumQueues; ++i)
+      if (mQueues[i].top.load(std::memory_order_relaxed) != EMPTY)
+        return false;
+    return true;
+  }
+
+  // Push into a random unlocked heap. If that heap already holds an
+  // element of the same key, the two merge into the one of higher priority
+  // and false is returned; true means the queue grew by one element.
+  bool push(const T &elem) {
+    for (;;) {
+      queue_t &q = mQueues[random_queue()];
+      if (!q.lock.try_lock())
+        continue;
+      const T *queued = q.heap.find(elem);
+      const bool added = !queued;
+      if (added || mKey(elem) < mKey(*queued)) {
+        q.heap.push(elem);
+        q.publish_top(mKey);
+      }
+      q.lock.unlock();
+      return added;
+    }
+  }
+
+  // Pop the better top of two random heaps into 'out'. Returns false if
+  // all the heaps were found empty.
+  bool try_pop(T &out) {
+    for (;;) {
+      size_t i = random_queue();
+      const size_t j = random_queue();
+      priority_t ki = mQueues[i].top.load(std::memory_order_relaxed);
+      const priority_t kj = mQueues[j].top.load(std::memory_order_relaxed);
+      if (kj < ki) {
+        i = j;
+        ki = kj;
+      }
+
+      if (ki == EMPTY) {
+        if (empty())
+          return false;
+        continue;
+      }
+
+      queue_t &q = mQueues[i];
+      if (!q.lock.try_lock())
+        continue;
+      // Another thread may have emptied the heap since the peek.
+      if (q.heap.empty()) {
+        q.lock.unlock();
+        continue;
+      }
+      out = q.heap.top();
+      q.heap.pop();
+      // Nobody holds handles into the heaps: let an empty heap start its
+      // handles afresh instead of growing its handle table forever.
+      if (q.heap.empty())
+        q.heap.clear();
+      q.publish_top(mKey);
+      q.lock.unlock();
+      return true;
+    }
+  }
+};
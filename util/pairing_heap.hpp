@@ -0,0 +1,298 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#ifdef DEBUG_IPQ
+#include <cassert>
+#endif
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A pairing heap of elements of type T with the interface of
+// indexed_priority_queue (push/top/pop/update/find and the handle based
+// contains/priority/decrease_key), so that the two are interchangeable.
+//
+// A pairing heap is a heap-ordered multi-way tree. push and decrease_key
+// meld a single node with the root in O(1); pop merges the children of the
+// root pairwise, left to right, and then folds the pairs right to left, in
+// O(lg n) amortized. Decrease-key heavy workloads such as Dijkstra's
+// algorithm on dense graphs benefit from the O(1) (amortized o(lg n))
+// decrease-key.
+//
+// Nodes are allocated from a pool (a vector) and linked by indices; the
+// index of a node is the handle of its element. As with
+// indexed_priority_queue, a handle keeps referring to the same element
+// until the queue is cleared. The elements to handle mapping used by
+// push/update/find is maintained using a hash map.
+template <class T, class CMP = std::less<T>, class HASH = std::hash<T>,
+          class PRED = std::equal_to<T>>
+class pairing_heap {
+
+public:
+  typedef size_t handle_t;
+
+private:
+  static constexpr size_t NIL = static_cast<size_t>(-1);
+
+  struct node_t {
+    T elem;
+    // Leftmost child and right sibling.
+    size_t child;
+    size_t sibling;
+    // Parent for a leftmost child, left sibling otherwise. NIL for the root
+    // and for nodes that are not queued.
+    size_t prev;
+    bool queued;
+
+    explicit node_t(const T &e)
+        : elem(e), child(NIL), sibling(NIL), prev(NIL), queued(true) {}
+  };
+
+  CMP mCmp;
+
+  // Node pool.
+  std::vector<node_t> mNodes;
+
+  size_t mRoot;
+  size_t mSize;
+
+  // Hash-map of element to handle.
+  typedef std::unordered_map<T, handle_t, HASH, PRED> IndexT;
+  IndexT mIndex;
+
+  // Scratch space of merge_pairs, kept to avoid an allocation per pop.
+  std::vector<size_t> mPairs;
+
+  // Link two roots; the one with the lower priority becomes the leftmost
+  // child of the other. Returns the new root.
+  size_t meld(size_t a, size_t b) {
+    if (a == NIL)
+      return b;
+    if (b == NIL)
+      return a;
+    if (mCmp(mNodes[b].elem, mNodes[a].elem))
+      std::swap(a, b);
+
+    node_t &na = mNodes[a];
+    node_t &nb = mNodes[b];
+    nb.prev = a;
+    nb.sibling = na.child;
+    if (na.child != NIL)
+      mNodes[na.child].prev = b;
+    na.child = b;
+    return a;
+  }
+
+  // Merge a list of siblings into a single tree: meld them in pairs from
+  // left to right, then meld the pairs from right to left.
+  size_t merge_pairs(size_t first) {
+    mPairs.clear();
+    while (first != NIL) {
+      const size_t a = first;
+      const size_t b = mNodes[a].sibling;
+      first = (b != NIL) ? mNodes[b].sibling : NIL;
+      mNodes[a].sibling = mNodes[a].prev = NIL;
+      if (b != NIL)
+        mNodes[b].sibling = mNodes[b].prev = NIL;
+      mPairs.push_back(meld(a, b));
+    }
+
+    size_t root = NIL;
+    for (auto itr = mPairs.rbegin(); itr != mPairs.rend(); ++itr)
+      root = meld(*itr, root);
+    return root;
+  }
+
+  // Detach the subtree rooted at a non-root node from its parent.
+  void cut(size_t h) {
+    node_t &n = mNodes[h];
+    if (mNodes[n.prev].child == h)
+      mNodes[n.prev].child = n.sibling;
+    else
+      mNodes[n.prev].sibling = n.sibling;
+    if (n.sibling != NIL)
+      mNodes[n.sibling].prev = n.prev;
+    n.sibling = n.prev = NIL;
+  }
+
+  // Replace the element of a queued node and restore the heap order.
+  void update_at(size_t h, const T &to) {
+    const bool lowered = mCmp(mNodes[h].elem, to);
+    mNodes[h].elem = to;
+
+    if (h != mRoot)
+      cut(h);
+    else
+      mRoot = NIL;
+
+    if (lowered) {
+      // The children may now precede the node: detach them too.
+      const size_t children = merge_pairs(mNodes[h].child);
+      mNodes[h].child = NIL;
+      mRoot = meld(mRoot, children);
+    }
+    mRoot = meld(mRoot, h);
+  }
+
+#ifdef DEBUG_IPQ
+  // Check the heap order and the links of the subtree at h. Returns its
+  // size.
+  size_t tree_sanity_check(size_t h) const {
+    size_t n = 1;
+    size_t prev = h;
+    for (size_t c = mNodes[h].child; c != NIL; c = mNodes[c].sibling) {
+      assert(mNodes[c].queued);
+      assert(mNodes[c].prev == prev);
+      assert(!mCmp(mNodes[c].elem, mNodes[h].elem));
+      n += tree_sanity_check(c);
+      prev = c;
+    }
+    return n;
+  }
+
+  // Called after modifying the internal data-structures.
+  void sanity_check() const {
+    assert(mIndex.size() == mSize);
+    assert((mRoot == NIL) == (mSize == 0));
+    if (mRoot != NIL) {
+      assert(mNodes[mRoot].prev == NIL && mNodes[mRoot].sibling == NIL);
+      assert(tree_sanity_check(mRoot) == mSize);
+    }
+    for (const auto &i : mIndex) {
+      assert(mNodes[i.second].queued);
+      assert(mIndex.key_eq()(i.first, mNodes[i.second].elem));
+    }
+  }
+#else
+#define sanity_check()
+#endif
+
+  // Restore the heap order after the priority of a queued node was raised:
+  // its subtree moves up to the root list.
+  void raise(size_t h) {
+    if (h != mRoot) {
+      cut(h);
+      mRoot = meld(mRoot, h);
+    }
+    sanity_check();
+  }
+
+public:
+  pairing_heap() : mRoot(NIL), mSize(0) {}
+
+  // Returns the top-priority element.
+  const T &top() const { return mNodes[mRoot].elem; }
+
+  bool empty() const { return mSize == 0; }
+
+  size_t size() const { return mSize; }
+
+  // Remove all elements. Invalidates all handles.
+  void clear() {
+    mNodes.clear();
+    mIndex.clear();
+    mRoot = NIL;
+    mSize = 0;
+  }
+
+  // Remove the root and merge its children.
+  void pop() {
+    if (empty())
+      return;
+
+    node_t &r = mNodes[mRoot];
+    r.queued = false;
+    mIndex.erase(r.elem);
+    const size_t children = r.child;
+    r.child = NIL;
+    mRoot = merge_pairs(children);
+    --mSize;
+    sanity_check();
+  }
+
+  // Meld the argument element as a single node tree with the root. If the
+  // element is already queued, update it instead. Returns the handle of the
+  // element.
+  handle_t push(const T &elem) {
+    auto itr = mIndex.find(elem);
+    if (itr != mIndex.end()) {
+      const auto h = itr->second;
+      update_at(h, elem);
+      sanity_check();
+      return h;
+    }
+
+    const handle_t h = mNodes.size();
+    mNodes.push_back(node_t(elem));
+    mIndex.emplace(elem, h);
+    mRoot = meld(mRoot, h);
+    ++mSize;
+    sanity_check();
+    return h;
+  }
+
+  // Update the element 'from' with 'to'.
+  bool update(const T &from, const T &to) {
+    auto itr = mIndex.find(from);
+    if (itr == mIndex.end())
+      return false;
+
+    const auto h = itr->second;
+    // The hash map needs to change only if the key does.
+    if (!mIndex.key_eq()(from, to)) {
+      mIndex.erase(itr);
+      mIndex.emplace(to, h);
+    }
+    update_at(h, to);
+
+    sanity_check();
+    return true;
+  }
+
+  const T &find(const T &elem, const T &not_found) const {
+    auto itr = mIndex.find(elem);
+    return (itr == mIndex.end()) ? not_found : mNodes[itr->second].elem;
+  }
+
+  // Whether the element of a handle is still queued.
+  bool contains(handle_t h) const {
+    return h < mNodes.size() && mNodes[h].queued;
+  }
+
+  // The element (and so the priority) of a queued handle.
+  const T &priority(handle_t h) const { return mNodes[h].elem; }
+
+  // Raise the priority of the element of a queued handle to that of 'to'.
+  // 'to' must have the same key (as per PRED) as the element it replaces and
+  // must not have a lower priority. Does not hash.
+  void decrease_key(handle_t h, T to) {
+#ifdef DEBUG_IPQ
+    assert(mIndex.key_eq()(mNodes[h].elem, to));
+    assert(!mCmp(mNodes[h].elem, to));
+#endif
+    mNodes[h].elem = std::move(to);
+    raise(h);
+  }
+
+  // decrease_key for elements that are (key, priority) pairs, e.g. (vertex,
+  // cost): only the new priority p is given and it is written in place, so
+  // the key is not copied.
+  template <class U = T>
+  void decrease_key(handle_t h, const typename U::second_type &p) {
+#ifdef DEBUG_IPQ
+    T to(mNodes[h].elem);
+    to.second = p;
+    assert(!mCmp(mNodes[h].elem, to));
+#endif
+    mNodes[h].elem.second = p;
+    raise(h);
+  }
+};
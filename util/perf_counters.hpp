@@ -0,0 +1,206 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters of the calling thread, read through Linux
+// perf_event_open. Each event is opened independently so that a missing
+// event (e.g. LLC misses inside a VM) does not take the others down with it.
+// When no counter can be opened (non-Linux, restrictive
+// perf_event_paranoid, containers) available() is false and every sample
+// comes back marked invalid, so callers silently fall back to time-only.
+class perf_counters {
+public:
+  enum event_t {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    NUM_EVENTS
+  };
+
+  // Counter values of one start()/stop() interval.
+  struct sample_t {
+    uint64_t value[NUM_EVENTS];
+    bool valid[NUM_EVENTS];
+
+    sample_t() {
+      for (int e = 0; e < NUM_EVENTS; ++e) {
+        value[e] = 0;
+        valid[e] = false;
+      }
+    }
+
+    bool any_valid() const {
+      for (int e = 0; e < NUM_EVENTS; ++e)
+        if (valid[e])
+          return true;
+      return false;
+    }
+
+    // Instructions per cycle; 0 if either counter is unavailable.
+    double ipc() const {
+      if (!valid[CYCLES] || !valid[INSTRUCTIONS] || value[CYCLES] == 0)
+        return 0.0;
+      return static_cast<double>(value[INSTRUCTIONS]) / value[CYCLES];
+    }
+
+    // Print the valid counters divided by the number of operations the
+    // interval covered.
+    void print(std::ostream &os, uint64_t ops = 1) const {
+      if (!any_valid()) {
+        os << "counters: n/a";
+        return;
+      }
+      const double div = ops ? static_cast<double>(ops) : 1.0;
+      const char *sep = "";
+      for (int e = 0; e < NUM_EVENTS; ++e) {
+        if (valid[e]) {
+          os << sep << name(static_cast<event_t>(e)) << "=" << value[e] / div;
+          sep = " ";
+        }
+      }
+      if (valid[CYCLES] && valid[INSTRUCTIONS])
+        os << sep << "IPC=" << ipc();
+      if (ops > 1)
+        os << " (per op, " << ops << " ops)";
+    }
+  };
+
+  static const char *name(event_t e) {
+    switch (e) {
+    case CYCLES:
+      return "cycles";
+    case INSTRUCTIONS:
+      return "instructions";
+    case L1D_MISSES:
+      return "L1d-misses";
+    case LLC_MISSES:
+      return "LLC-misses";
+    case BRANCH_MISSES:
+      return "branch-misses";
+    case NUM_EVENTS:
+    default:
+      return "?";
+    }
+  }
+
+private:
+  int mFd[NUM_EVENTS];
+
+#ifdef __linux__
+  static int open_event(uint32_t type, uint64_t config) {
+    struct perf_event_attr pe;
+    std::memset(&pe, 0, sizeof(pe));
+    pe.type = type;
+    pe.size = sizeof(pe);
+    pe.config = config;
+    pe.disabled = 1;
+    pe.exclude_kernel = 1;
+    pe.exclude_hv = 1;
+    pe.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &pe, 0, -1, -1,
+                                    PERF_FLAG_FD_CLOEXEC));
+  }
+
+  // Read a counter, scaling it up if the kernel had to multiplex it.
+  static bool read_event(int fd, uint64_t &value) {
+    uint64_t buf[3] = {0, 0, 0}; // value, time enabled, time running
+    if (read(fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)))
+      return false;
+    value = (buf[2] && buf[2] < buf[1])
+                ? static_cast<uint64_t>(static_cast<double>(buf[0]) * buf[1] /
+                                        buf[2])
+                : buf[0];
+    return true;
+  }
+#endif
+
+public:
+  perf_counters() {
+    for (int e = 0; e < NUM_EVENTS; ++e)
+      mFd[e] = -1;
+#ifdef __linux__
+    const uint64_t l1d_miss = PERF_COUNT_HW_CACHE_L1D |
+                              (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    mFd[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    mFd[INSTRUCTIONS] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    mFd[L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, l1d_miss);
+    mFd[LLC_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    mFd[BRANCH_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+  }
+
+  ~perf_counters() {
+#ifdef __linux__
+    for (int e = 0; e < NUM_EVENTS; ++e)
+      if (mFd[e] >= 0)
+        close(mFd[e]);
+#endif
+  }
+
+  perf_counters(const perf_counters &) = delete;
+  perf_counters &operator=(const perf_counters &) = delete;
+
+  // Whether at least one counter could be opened.
+  bool available() const {
+    for (int e = 0; e < NUM_EVENTS; ++e)
+      if (mFd[e] >= 0)
+        return true;
+    return false;
+  }
+
+  // Reset and enable all open counters.
+  void start() {
+#ifdef __linux__
+    for (int e = 0; e < NUM_EVENTS; ++e) {
+      if (mFd[e] >= 0) {
+        ioctl(mFd[e], PERF_EVENT_IOC_RESET, 0);
+        ioctl(mFd[e], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  // Disable all open counters and return their values.
+  sample_t stop() {
+    sample_t s;
+#ifdef __linux__
+    for (int e = 0; e < NUM_EVENTS; ++e)
+      if (mFd[e] >= 0)
+        ioctl(mFd[e], PERF_EVENT_IOC_DISABLE, 0);
+    for (int e = 0; e < NUM_EVENTS; ++e)
+      if (mFd[e] >= 0)
+        s.valid[e] = read_event(mFd[e], s.value[e]);
+#endif
+    return s;
+  }
+};
+
+inline std::ostream &operator<<(std::ostream &os,
+                                const perf_counters::sample_t &s) {
+  s.print(os);
+  return os;
+}
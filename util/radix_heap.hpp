@@ -0,0 +1,295 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#ifdef DEBUG_IPQ
+#include <cassert>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A radix heap: a min priority queue of elements of type T for monotone,
+// non-negative integer priorities, with the interface of
+// indexed_priority_queue (push/top/pop/update/find and the handle based
+// contains/priority/decrease_key), so that the two are interchangeable in
+// Dijkstra's algorithm.
+//
+// The functor KEY maps an element to its priority (an unsigned integer of
+// up to 64 bits). The queue is monotone: no element may be given a priority
+// lower than that of the last top element, which holds in Dijkstra's
+// algorithm with non-negative edge costs. Compile with DEBUG_IPQ to assert
+// it.
+//
+// An element of priority k lives in bucket 0 if k equals the last top
+// priority, and otherwise in the bucket of the highest bit in which k
+// differs from it. push and decrease_key are O(1): they only (re)place the
+// element into a bucket. When top finds bucket 0 empty, the lowest
+// non-empty bucket is scanned for its minimum, which becomes the new last
+// top priority, and its elements are redistributed into lower buckets (the
+// reason for the mutable members). An element moves down at most 64 times
+// over its lifetime, so top and pop are O(lg C) amortized for priorities up
+// to C.
+//
+// As with indexed_priority_queue, push returns a handle that keeps
+// referring to the same element until the queue is cleared, and the
+// elements to handle mapping used by push/update/find is a hash map.
+template <class T, class KEY, class HASH = std::hash<T>,
+          class PRED = std::equal_to<T>>
+class radix_heap {
+
+public:
+  typedef size_t handle_t;
+  typedef uint64_t priority_t;
+
+private:
+  enum { NUM_BUCKETS = 65, NOT_QUEUED = NUM_BUCKETS };
+
+  struct node_t {
+    T elem;
+    priority_t key;
+    // Bucket (or NOT_QUEUED) and position in the bucket.
+    size_t bucket;
+    size_t slot;
+
+    node_t(const T &e, priority_t k) : elem(e), key(k), bucket(0), slot(0) {}
+  };
+
+  KEY mKey;
+
+  // Node pool.
+  mutable std::vector<node_t> mNodes;
+
+  // Handles of the elements in each bucket.
+  mutable std::vector<handle_t> mBuckets[NUM_BUCKETS];
+
+  // Priority of the last top element.
+  mutable priority_t mLast;
+
+  size_t mSize;
+
+  // Hash-map of element to handle.
+  typedef std::unordered_map<T, handle_t, HASH, PRED> IndexT;
+  IndexT mIndex;
+
+  size_t bucket_of(priority_t k) const {
+    return (k == mLast) ? 0 : 64 - __builtin_clzll(k ^ mLast);
+  }
+
+  void check_monotone(priority_t k) const {
+#ifdef DEBUG_IPQ
+    assert(k >= mLast);
+#else
+    (void)k;
+#endif
+  }
+
+  void bucket_insert(handle_t h) const {
+    node_t &n = mNodes[h];
+    n.bucket = bucket_of(n.key);
+    n.slot = mBuckets[n.bucket].size();
+    mBuckets[n.bucket].push_back(h);
+  }
+
+  // Remove from its bucket by moving the last element of the bucket into
+  // its slot.
+  void bucket_erase(handle_t h) {
+    auto &b = mBuckets[mNodes[h].bucket];
+    const handle_t moved = b.back();
+    b[mNodes[h].slot] = moved;
+    mNodes[moved].slot = mNodes[h].slot;
+    b.pop_back();
+  }
+
+  // Make bucket 0 hold the minimum, if the queue is not empty.
+  void refill() const {
+    if (!mBuckets[0].empty() || mSize == 0)
+      return;
+
+    size_t i = 1;
+    while (mBuckets[i].empty())
+      ++i;
+
+    auto &b = mBuckets[i];
+    priority_t min = mNodes[b.front()].key;
+    for (const auto h : b)
+      if (mNodes[h].key < min)
+        min = mNodes[h].key;
+
+    mLast = min;
+    std::vector<handle_t> moving;
+    moving.swap(b);
+    for (const auto h : moving)
+      bucket_insert(h);
+    // Hand the capacity back to the bucket.
+    moving.clear();
+    b.swap(moving);
+  }
+
+  // Replace the element of a queued node and rebucket it.
+  void update_at(handle_t h, const T &to) {
+    const priority_t k = mKey(to);
+    check_monotone(k);
+    bucket_erase(h);
+    mNodes[h].elem = to;
+    mNodes[h].key = k;
+    bucket_insert(h);
+  }
+
+#ifdef DEBUG_IPQ
+  // Called after modifying the internal data-structures.
+  void sanity_check() const {
+    size_t n = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      for (size_t s = 0; s < mBuckets[i].size(); ++s) {
+        const node_t &nd = mNodes[mBuckets[i][s]];
+        assert(nd.bucket == i && nd.slot == s);
+        assert(nd.key == mKey(nd.elem));
+        assert(bucket_of(nd.key) == i);
+        ++n;
+      }
+    }
+    assert(n == mSize && mIndex.size() == mSize);
+  }
+#else
+#define sanity_check()
+#endif
+
+  // Rebucket a queued node after its priority was lowered. An element of
+  // bucket 0 already has the lowest possible priority.
+  void lower(handle_t h) {
+    const priority_t k = mKey(mNodes[h].elem);
+    check_monotone(k);
+    mNodes[h].key = k;
+    if (mNodes[h].bucket != 0 && bucket_of(k) != mNodes[h].bucket) {
+      bucket_erase(h);
+      bucket_insert(h);
+    }
+    sanity_check();
+  }
+
+public:
+  radix_heap() : mLast(0), mSize(0) {}
+
+  // Returns the top-priority (lowest) element.
+  const T &top() const {
+    refill();
+    return mNodes[mBuckets[0].back()].elem;
+  }
+
+  bool empty() const { return mSize == 0; }
+
+  size_t size() const { return mSize; }
+
+  // Remove all elements. Invalidates all handles and restarts the
+  // monotone sequence of priorities from 0.
+  void clear() {
+    mNodes.clear();
+    for (auto &b : mBuckets)
+      b.clear();
+    mIndex.clear();
+    mLast = 0;
+    mSize = 0;
+  }
+
+  void pop() {
+    if (empty())
+      return;
+
+    refill();
+    const handle_t h = mBuckets[0].back();
+    mBuckets[0].pop_back();
+    mNodes[h].bucket = NOT_QUEUED;
+    mIndex.erase(mNodes[h].elem);
+    --mSize;
+    sanity_check();
+  }
+
+  // Put the argument element into its bucket. If the element is already
+  // queued, update it instead. Returns the handle of the element.
+  handle_t push(const T &elem) {
+    auto itr = mIndex.find(elem);
+    if (itr != mIndex.end()) {
+      const auto h = itr->second;
+      update_at(h, elem);
+      sanity_check();
+      return h;
+    }
+
+    const priority_t k = mKey(elem);
+    check_monotone(k);
+    const handle_t h = mNodes.size();
+    mNodes.push_back(node_t(elem, k));
+    mIndex.emplace(elem, h);
+    bucket_insert(h);
+    ++mSize;
+    sanity_check();
+    return h;
+  }
+
+  // Update the element 'from' with 'to'.
+  bool update(const T &from, const T &to) {
+    auto itr = mIndex.find(from);
+    if (itr == mIndex.end())
+      return false;
+
+    const auto h = itr->second;
+    // The hash map needs to change only if the key does.
+    if (!mIndex.key_eq()(from, to)) {
+      mIndex.erase(itr);
+      mIndex.emplace(to, h);
+    }
+    update_at(h, to);
+
+    sanity_check();
+    return true;
+  }
+
+  const T &find(const T &elem, const T &not_found) const {
+    auto itr = mIndex.find(elem);
+    return (itr == mIndex.end()) ? not_found : mNodes[itr->second].elem;
+  }
+
+  // Whether the element of a handle is still queued.
+  bool contains(handle_t h) const {
+    return h < mNodes.size() && mNodes[h].bucket != NOT_QUEUED;
+  }
+
+  // The element (and so the priority) of a queued handle.
+  const T &priority(handle_t h) const { return mNodes[h].elem; }
+
+  // Lower the priority of the element of a queued handle to that of 'to'.
+  // 'to' must have the same key (as per PRED) as the element it replaces, a
+  // priority not above the current one and not below the last top one.
+  // Does not hash.
+  void decrease_key(handle_t h, T to) {
+#ifdef DEBUG_IPQ
+    assert(mIndex.key_eq()(mNodes[h].elem, to));
+    assert(mKey(to) <= mNodes[h].key);
+#endif
+    mNodes[h].elem = std::move(to);
+    lower(h);
+  }
+
+  // decrease_key for elements that are (key, priority) pairs, e.g. (vertex,
+  // cost): only the new priority p is given and it is written in place, so
+  // the key is not copied.
+  template <class U = T>
+  void decrease_key(handle_t h, const typename U::second_type &p) {
+#ifdef DEBUG_IPQ
+    T to(mNodes[h].elem);
+    to.second = p;
+    assert(mKey(to) <= mNodes[h].key);
+#endif
+    mNodes[h].elem.second = p;
+    lower(h);
+  }
+};
@@ -0,0 +1,229 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Fast, reproducible pseudo random number generators replacing rand().
+//
+// xoshiro256 is xoshiro256** (Blackman and Vigna): 256 bits of state,
+// period 2^256 - 1, a handful of shifts and xors per 64-bit output and no
+// hidden global state. jump() advances a generator by 2^128 outputs, so
+// stream(i) hands thread i a sequence that never overlaps with the
+// sequences of the other threads of the same seed.
+//
+// xoshiro256x4 runs four such streams in lock-step with the state laid out
+// lane-wise, so that the compiler can keep the four lanes in one SIMD
+// register when filling large arrays.
+//
+// Bounded values use Lemire's multiply-shift method, which is unbiased and
+// needs a division only on rare rejections (unlike rand() % n).
+
+namespace rng_util {
+
+inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+// Used to expand a 64-bit seed into a full state.
+inline uint64_t splitmix64(uint64_t &x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Map a uniform 32-bit value into [0, range) without bias; next() supplies
+// fresh 32-bit values when a rejection is needed.
+template <typename NEXT32>
+inline uint32_t bounded32(uint32_t x, uint32_t range, NEXT32 &&next) {
+  uint64_t m = static_cast<uint64_t>(x) * range;
+  uint32_t l = static_cast<uint32_t>(m);
+  if (l < range) {
+    const uint32_t t = static_cast<uint32_t>(-range) % range;
+    while (l < t) {
+      m = static_cast<uint64_t>(next()) * range;
+      l = static_cast<uint32_t>(m);
+    }
+  }
+  return static_cast<uint32_t>(m >> 32);
+}
+
+} // namespace rng_util
+
+class xoshiro256 {
+private:
+  friend class xoshiro256x4;
+
+  uint64_t mS[4];
+
+  void apply_jump(const uint64_t (&poly)[4]) {
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (auto p : poly) {
+      for (int b = 0; b < 64; ++b) {
+        if (p & (uint64_t(1) << b))
+          for (int i = 0; i < 4; ++i)
+            s[i] ^= mS[i];
+        next();
+      }
+    }
+    for (int i = 0; i < 4; ++i)
+      mS[i] = s[i];
+  }
+
+public:
+  // UniformRandomBitGenerator interface: usable with std::shuffle and the
+  // <random> distributions.
+  typedef uint64_t result_type;
+
+  static constexpr result_type min() { return 0; }
+
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  explicit xoshiro256(uint64_t seed = 2147483647) { reseed(seed); }
+
+  void reseed(uint64_t seed) {
+    for (auto &s : mS)
+      s = rng_util::splitmix64(seed);
+  }
+
+  uint64_t next() {
+    const uint64_t result = rng_util::rotl(mS[1] * 5, 7) * 9;
+    const uint64_t t = mS[1] << 17;
+    mS[2] ^= mS[0];
+    mS[3] ^= mS[1];
+    mS[1] ^= mS[2];
+    mS[0] ^= mS[3];
+    mS[2] ^= t;
+    mS[3] = rng_util::rotl(mS[3], 45);
+    return result;
+  }
+
+  result_type operator()() { return next(); }
+
+  // The upper bits are the better ones.
+  uint32_t next32() { return static_cast<uint32_t>(next() >> 32); }
+
+  // Uniform in [0, range). range must be > 0.
+  uint32_t bounded(uint32_t range) {
+    return rng_util::bounded32(next32(), range, [this]() { return next32(); });
+  }
+
+  // Uniform in [lo, hi], both inclusive.
+  uint32_t uniform(uint32_t lo, uint32_t hi) {
+    const uint32_t span = hi - lo + 1;
+    return span ? lo + bounded(span) : next32(); // span 0: full range.
+  }
+
+  // Uniform in [0, 1).
+  double next_double() { return (next() >> 11) * 0x1.0p-53; }
+
+  // Advance by 2^128 outputs.
+  void jump() {
+    static const uint64_t JUMP[4] = {0x180ec6d33cfd0abaULL,
+                                     0xd5a61266f0c9392cULL,
+                                     0xa9582618e03fc9aaULL,
+                                     0x39abdc4529b1661cULL};
+    apply_jump(JUMP);
+  }
+
+  // Advance by 2^192 outputs.
+  void long_jump() {
+    static const uint64_t LONG_JUMP[4] = {0x76e15d3efefdcbbfULL,
+                                          0xc5004e441c522fb3ULL,
+                                          0x77710069854ee241ULL,
+                                          0x39109bb02acbe635ULL};
+    apply_jump(LONG_JUMP);
+  }
+
+  // Independent generator number i derived from this one: this generator
+  // advanced by i * 2^128 outputs. Meant to give each thread its own stream.
+  xoshiro256 stream(size_t i) const {
+    xoshiro256 g(*this);
+    for (size_t j = 0; j < i; ++j)
+      g.jump();
+    return g;
+  }
+
+  void fill(uint32_t *out, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+      out[i] = next32();
+  }
+
+  // Fill with values uniform in [0, range).
+  void fill_bounded(uint32_t *out, size_t n, uint32_t range) {
+    for (size_t i = 0; i < n; ++i)
+      out[i] = bounded(range);
+  }
+};
+
+// Four xoshiro256** streams (stream(0) .. stream(3) of the seed) advanced
+// together for bulk generation.
+class xoshiro256x4 {
+public:
+  enum { LANES = 4 };
+
+private:
+  // mS[word][lane]
+  uint64_t mS[4][LANES];
+
+  // One output per lane.
+  void next4(uint64_t (&res)[LANES]) {
+    for (int l = 0; l < LANES; ++l) {
+      res[l] = rng_util::rotl(mS[1][l] * 5, 7) * 9;
+      const uint64_t t = mS[1][l] << 17;
+      mS[2][l] ^= mS[0][l];
+      mS[3][l] ^= mS[1][l];
+      mS[1][l] ^= mS[2][l];
+      mS[0][l] ^= mS[3][l];
+      mS[2][l] ^= t;
+      mS[3][l] = rng_util::rotl(mS[3][l], 45);
+    }
+  }
+
+  // Scalar generator used for rejections.
+  xoshiro256 mTail;
+
+public:
+  explicit xoshiro256x4(uint64_t seed = 2147483647) : mTail(seed) {
+    // Lane l is stream(l) of the seed; the tail generator continues past
+    // the last lane.
+    for (int l = 0; l < LANES; ++l) {
+      for (int w = 0; w < 4; ++w)
+        mS[w][l] = mTail.mS[w];
+      mTail.jump();
+    }
+  }
+
+  void fill(uint32_t *out, size_t n) {
+    uint64_t r[LANES];
+    size_t i = 0;
+    for (; i + 2 * LANES <= n; i += 2 * LANES) {
+      next4(r);
+      for (int l = 0; l < LANES; ++l) {
+        out[i + 2 * l] = static_cast<uint32_t>(r[l] >> 32);
+        out[i + 2 * l + 1] = static_cast<uint32_t>(r[l]);
+      }
+    }
+    // The tail, fewer than 2 * LANES values. Its trip count is bounded
+    // explicitly so that GCC does not lose the bound when n is a constant.
+    for (size_t j = 0; j < n % (2 * LANES); ++j)
+      out[i + j] = mTail.next32();
+  }
+
+  // Fill with values uniform in [0, range).
+  void fill_bounded(uint32_t *out, size_t n, uint32_t range) {
+    fill(out, n);
+    auto next = [this]() { return mTail.next32(); };
+    for (size_t i = 0; i < n; ++i)
+      out[i] = rng_util::bounded32(out[i], range, next);
+  }
+};
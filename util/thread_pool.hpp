@@ -0,0 +1,255 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cache_aligned.hpp"
+
+// A work-stealing thread pool with fork-join helpers.
+//
+// Every worker owns a deque of tasks. A task submitted by a worker goes to
+// the back of its own deque, and the worker takes its next task from there
+// too (LIFO, which keeps the recursion of fork-join code depth-first and
+// its data in cache). An idle worker steals from the front of the other
+// deques (FIFO, the oldest and so typically biggest pieces of work).
+// Tasks submitted from outside the pool are dealt to the deques round
+// robin. Workers with nothing to run or steal sleep on a condition
+// variable.
+//
+// task_group waits for the tasks it ran; the waiting thread executes
+// queued tasks meanwhile instead of blocking, so that recursive fork-join
+// on a pool of any size cannot deadlock. parallel_invoke and parallel_for
+// are built on it.
+//
+// Algorithms take an optional thread_pool pointer: with nullptr the
+// helpers run everything on the calling thread, in order, so the same
+// code serves the sequential case. Tasks must not throw.
+class thread_pool {
+public:
+  typedef std::function<void()> task_t;
+
+private:
+  // A deque per worker, each on its own cache line.
+  struct alignas(CACHE_LINE_SIZE) worker_queue_t {
+    std::mutex lock;
+    std::deque<task_t> tasks;
+  };
+
+  const size_t mNumWorkers;
+  std::unique_ptr<worker_queue_t[]> mQueues;
+  std::vector<std::thread> mThreads;
+
+  // Tasks in all the deques.
+  std::atomic<size_t> mQueued;
+
+  // Deque for the next task submitted from outside the pool.
+  std::atomic<size_t> mNextQueue;
+
+  std::mutex mSleepLock;
+  std::condition_variable mWake;
+  bool mStop;
+
+  // The pool and the deque of the calling thread, if it is a worker.
+  struct worker_id_t {
+    const thread_pool *pool;
+    size_t index;
+  };
+
+  static worker_id_t &this_worker() {
+    thread_local worker_id_t w = {nullptr, 0};
+    return w;
+  }
+
+  bool is_worker() const { return this_worker().pool == this; }
+
+  bool pop_back(size_t i, task_t &t) {
+    worker_queue_t &q = mQueues[i];
+    std::lock_guard<std::mutex> lg(q.lock);
+    if (q.tasks.empty())
+      return false;
+    t = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    mQueued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool pop_front(size_t i, task_t &t) {
+    worker_queue_t &q = mQueues[i];
+    std::lock_guard<std::mutex> lg(q.lock);
+    if (q.tasks.empty())
+      return false;
+    t = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    mQueued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Steal from the deques after 'from', in order.
+  bool steal(size_t from, task_t &t) {
+    for (size_t k = 1; k <= mNumWorkers; ++k)
+      if (pop_front((from + k) % mNumWorkers, t))
+        return true;
+    return false;
+  }
+
+  // Next task for the calling thread: its own newest task if it is a
+  // worker, the oldest task of another deque otherwise.
+  bool take(task_t &t) {
+    if (is_worker()) {
+      const size_t i = this_worker().index;
+      return pop_back(i, t) || steal(i, t);
+    }
+    return steal(mNumWorkers - 1, t);
+  }
+
+  void worker_loop(size_t i) {
+    this_worker() = worker_id_t{this, i};
+    task_t t;
+    for (;;) {
+      if (take(t)) {
+        t();
+        t = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lk(mSleepLock);
+      mWake.wait(lk, [this]() {
+        return mStop || mQueued.load(std::memory_order_relaxed) > 0;
+      });
+      if (mStop && mQueued.load(std::memory_order_relaxed) == 0)
+        return;
+    }
+  }
+
+public:
+  // A pool of num_threads workers; by default one per hardware thread.
+  explicit thread_pool(size_t num_threads = std::thread::hardware_concurrency())
+      : mNumWorkers(std::max<size_t>(num_threads, 1)),
+        mQueues(new worker_queue_t[mNumWorkers]), mQueued(0), mNextQueue(0),
+        mStop(false) {
+    for (size_t i = 0; i < mNumWorkers; ++i)
+      mThreads.emplace_back(&thread_pool::worker_loop, this, i);
+  }
+
+  // Runs the queued tasks, then joins the workers.
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lg(mSleepLock);
+      mStop = true;
+    }
+    mWake.notify_all();
+    for (auto &t : mThreads)
+      t.join();
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  size_t size() const { return mNumWorkers; }
+
+  // Queue a task.
+  void submit(task_t t) {
+    const size_t i =
+        is_worker() ? this_worker().index
+                    : mNextQueue.fetch_add(1, std::memory_order_relaxed) %
+                          mNumWorkers;
+    {
+      worker_queue_t &q = mQueues[i];
+      std::lock_guard<std::mutex> lg(q.lock);
+      q.tasks.push_back(std::move(t));
+    }
+    mQueued.fetch_add(1, std::memory_order_relaxed);
+    // Taking the lock orders the increment with a worker going to sleep.
+    { std::lock_guard<std::mutex> lg(mSleepLock); }
+    mWake.notify_one();
+  }
+
+  // Run one queued task on the calling thread. Returns false if there was
+  // none.
+  bool run_one() {
+    task_t t;
+    if (!take(t))
+      return false;
+    t();
+    return true;
+  }
+};
+
+// A set of tasks that can be waited for together. Without a pool, run
+// calls the task right away.
+class task_group {
+private:
+  thread_pool *mPool;
+  std::atomic<size_t> mPending;
+
+public:
+  explicit task_group(thread_pool *pool) : mPool(pool), mPending(0) {}
+
+  task_group(const task_group &) = delete;
+  task_group &operator=(const task_group &) = delete;
+
+  ~task_group() { wait(); }
+
+  template <class F> void run(F &&f) {
+    if (!mPool) {
+      f();
+      return;
+    }
+    mPending.fetch_add(1, std::memory_order_relaxed);
+    mPool->submit([this, f]() {
+      f();
+      mPending.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  // Wait for all the tasks run so far, executing queued tasks (of any
+  // group) meanwhile.
+  void wait() {
+    while (mPending.load(std::memory_order_acquire) != 0)
+      if (!mPool->run_one())
+        std::this_thread::yield();
+  }
+};
+
+// Call all the functions, in parallel if a pool is given, and return when
+// they are done. The first one runs on the calling thread.
+template <class F, class... FS>
+void parallel_invoke(thread_pool *pool, F &&f, FS &&... fs) {
+  task_group tg(pool);
+  (tg.run(std::forward<FS>(fs)), ...);
+  f();
+  tg.wait();
+}
+
+// Call f(i) for every i in [begin, end). The range is split in halves
+// recursively, down to pieces of at most grain indices, which run as
+// tasks of the pool (on the calling thread, in order, without one).
+template <class F>
+void parallel_for(thread_pool *pool, size_t begin, size_t end, size_t grain,
+                  const F &f) {
+  if (!pool || end - begin <= std::max<size_t>(grain, 1)) {
+    for (size_t i = begin; i < end; ++i)
+      f(i);
+    return;
+  }
+  const size_t mid = begin + (end - begin) / 2;
+  parallel_invoke(
+      pool, [&]() { parallel_for(pool, begin, mid, grain, f); },
+      [&]() { parallel_for(pool, mid, end, grain, f); });
+}
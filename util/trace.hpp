@@ -0,0 +1,165 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+// Scoped tracing zones written out as Chrome trace-event JSON, viewable in
+// chrome://tracing or https://ui.perfetto.dev.
+//
+//   void solve() {
+//     TRACE_ZONE("solve");
+//     ...
+//     { TRACE_ZONE("phase 1"); ... }
+//   }
+//
+// Tracing is compiled in only when ENABLE_TRACE is defined, e.g.
+//   CXXFLAGS=-DENABLE_TRACE make
+// Otherwise TRACE_ZONE expands to nothing and costs nothing, so zones may
+// stay in hot loops.
+//
+// Each thread records completed zones into its own fixed size ring buffer
+// (TRACE_BUFFER_EVENTS events; the oldest are overwritten). At exit the
+// buffers of all threads are written to the file named by the TRACE_FILE
+// environment variable, or trace.json. Zone names must be string literals
+// (or otherwise outlive the program), as only the pointer is recorded.
+
+#ifdef ENABLE_TRACE
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS 65536
+#endif
+
+class trace {
+public:
+  // A completed zone.
+  struct event_t {
+    const char *name;
+    uint64_t ts_ns;
+    uint64_t dur_ns;
+  };
+
+  // Per-thread ring buffer of events.
+  struct buffer_t {
+    const uint32_t tid;
+    std::vector<event_t> events;
+    uint64_t count;
+
+    explicit buffer_t(uint32_t t)
+        : tid(t), events(TRACE_BUFFER_EVENTS), count(0) {}
+
+    void record(const char *name, uint64_t ts, uint64_t dur) {
+      events[count % events.size()] = event_t{name, ts, dur};
+      ++count;
+    }
+  };
+
+  // RAII zone: records its begin time on construction and the completed
+  // event on destruction.
+  class zone {
+    const char *const mName;
+    const uint64_t mStart;
+
+  public:
+    explicit zone(const char *name) : mName(name), mStart(now_ns()) {}
+
+    ~zone() { local_buffer().record(mName, mStart, now_ns() - mStart); }
+
+    zone(const zone &) = delete;
+    zone &operator=(const zone &) = delete;
+  };
+
+  // Nanoseconds since the first use of the tracer.
+  static uint64_t now_ns() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch)
+        .count();
+  }
+
+  // Write the events of all threads as Chrome trace-event JSON.
+  static void dump(std::ostream &os) { get_registry().dump(os); }
+
+private:
+  // Owns the buffers of all threads that ever recorded an event, so that
+  // events of exited threads survive until the dump at exit.
+  class registry {
+    std::mutex mLock;
+    std::vector<std::unique_ptr<buffer_t>> mBuffers;
+
+  public:
+    registry() {}
+
+    ~registry() {
+      const char *fname = std::getenv("TRACE_FILE");
+      std::ofstream ofs(fname ? fname : "trace.json");
+      dump(ofs);
+    }
+
+    buffer_t *new_buffer() {
+      std::lock_guard<std::mutex> lg(mLock);
+      mBuffers.emplace_back(
+          new buffer_t(static_cast<uint32_t>(mBuffers.size() + 1)));
+      return mBuffers.back().get();
+    }
+
+    void dump(std::ostream &os) {
+      std::lock_guard<std::mutex> lg(mLock);
+      const auto flags = os.flags();
+      const auto prec = os.precision();
+      os << std::fixed << std::setprecision(3);
+      os << "{\"traceEvents\": [" << std::endl;
+      const char *sep = "";
+      for (const auto &b : mBuffers) {
+        const uint64_t n = std::min<uint64_t>(b->count, b->events.size());
+        for (uint64_t i = b->count - n; i < b->count; ++i) {
+          const auto &e = b->events[i % b->events.size()];
+          os << sep << "{\"name\": \"" << e.name
+             << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << b->tid
+             << ", \"ts\": " << e.ts_ns / 1000.0
+             << ", \"dur\": " << e.dur_ns / 1000.0 << "}";
+          sep = ",\n";
+        }
+      }
+      os << std::endl << "]}" << std::endl;
+      os.flags(flags);
+      os.precision(prec);
+    }
+  };
+
+  static registry &get_registry() {
+    static registry r;
+    return r;
+  }
+
+  static buffer_t &local_buffer() {
+    // Make sure the registry outlives every thread_local pointer into it.
+    thread_local buffer_t *b = get_registry().new_buffer();
+    return *b;
+  }
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_ZONE(name) trace::zone TRACE_CONCAT(trace_zone_, __LINE__)(name)
+
+#else
+
+#define TRACE_ZONE(name)
+
+#endif
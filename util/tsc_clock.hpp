@@ -0,0 +1,118 @@
+//
+// Copyright 2021 Santanu Sen. All Rights Reserved.
+//
+// Licensed under the Apache License 2.0 (the "License"). You may not use
+// this file except in compliance with the License. You can obtain a copy
+// in the file LICENSE in the source distribution.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TSC_CLOCK_AVAILABLE
+#endif
+
+// Clock policies for exec_time. A clock policy provides:
+//   tick_t                   : an opaque time stamp type.
+//   start()                  : time stamp taken at the start of a capture.
+//   stop()                   : time stamp taken at the end of a capture.
+//   to_ms(start, stop)       : the duration between two time stamps in
+//                              milliseconds.
+
+// Portable clock based on std::chrono. Each time stamp costs a clock_gettime
+// call, i.e. tens of nanoseconds.
+struct chrono_clock {
+  typedef std::chrono::high_resolution_clock::time_point tick_t;
+
+  static tick_t start() { return std::chrono::high_resolution_clock::now(); }
+
+  static tick_t stop() { return std::chrono::high_resolution_clock::now(); }
+
+  static double to_ms(tick_t t1, tick_t t2) {
+    return std::chrono::duration<double, std::milli>(t2 - t1).count();
+  }
+};
+
+#ifdef TSC_CLOCK_AVAILABLE
+
+// Clock based on the CPU time stamp counter. Assumes an invariant TSC
+// (constant_tsc and nonstop_tsc in /proc/cpuinfo), which holds for any
+// x86 processor of the last decade.
+//
+// The reads are fenced so that the measured instructions cannot be
+// reordered out of the interval: start() is "lfence; rdtsc; lfence" and
+// stop() is "rdtscp; lfence". The tick rate is calibrated once against
+// std::chrono::steady_clock, and the cost of an empty start()/stop() pair is
+// measured once and subtracted from every duration.
+struct tsc_clock {
+  typedef uint64_t tick_t;
+
+  static tick_t start() {
+    _mm_lfence();
+    const tick_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+  }
+
+  static tick_t stop() {
+    unsigned int aux;
+    const tick_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+  }
+
+  static double to_ms(tick_t t1, tick_t t2) {
+    const tick_t ticks = t2 - t1;
+    const tick_t oh = overhead_ticks();
+    return ((ticks > oh) ? ticks - oh : 0) / ticks_per_ms();
+  }
+
+  // Measured TSC frequency.
+  static double ticks_per_ms() {
+    static const double tpms = calibrate();
+    return tpms;
+  }
+
+  // Minimum number of ticks of an empty capture.
+  static tick_t overhead_ticks() {
+    static const tick_t oh = measure_overhead();
+    return oh;
+  }
+
+private:
+  static double calibrate() {
+    // Busy wait for a few milliseconds and relate the two clocks. The
+    // error of the steady_clock reads is well below 0.1% of the interval.
+    const auto c1 = std::chrono::steady_clock::now();
+    const tick_t t1 = start();
+    std::chrono::steady_clock::time_point c2;
+    do {
+      c2 = std::chrono::steady_clock::now();
+    } while (c2 - c1 < std::chrono::milliseconds(20));
+    const tick_t t2 = stop();
+    std::chrono::duration<double, std::milli> ms = c2 - c1;
+    return (t2 - t1) / ms.count();
+  }
+
+  static tick_t measure_overhead() {
+    tick_t best = ~tick_t(0);
+    for (int i = 0; i < 1000; ++i) {
+      const tick_t t1 = start();
+      const tick_t t2 = stop();
+      best = std::min(best, t2 - t1);
+    }
+    return best;
+  }
+};
+
+#else
+
+// No time stamp counter: fall back to std::chrono.
+typedef chrono_clock tsc_clock;
+
+#endif